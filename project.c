@@ -5,11 +5,38 @@
     #include <limits.h>
     #include <float.h>
     #include <stdbool.h>
+    #include <stdint.h>
+    #include <ctype.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <sys/wait.h>
+    #include <sys/stat.h>
+    #include <sys/resource.h>
+    #include <signal.h>
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <dirent.h>
 
     #define MAX_LOCATIONS 100
     #define MAX_NAME_LENGTH 500
     #define MAX 100
     #define MAX_COMMENTS 100
+    #define MAX_SPECIALIZATIONS 32
+    #define MAX_NEAREST 5
+    #define MAX_SHARDS 16
+    #define TILE_DEGREES 0.05 // roughly 5.5 km tiles around Pune
+    #define SHARD_SOCKET_FORMAT "/tmp/hospital_shard_%d_of_%d.sock"
+    #define HOURS_PER_WEEK (7 * 24)
+    #define WEEK_WORDS ((HOURS_PER_WEEK + 63) / 64)
+    #define NO_ENTRY UINT32_MAX
+    #define FEES_UNKNOWN -1 // info.txt row without a readable fees field
+    #define ROADS_FILE "roads.txt"
+    #define HIERARCHY_FILE "roads.ch"
+    #define COMMENT_INDEX_FILE "comments.idx"
+    #define MAX_TOKEN_LENGTH 32
 
 
     struct Location {
@@ -17,32 +44,56 @@
         double latitude;
         double longitude;
         char specialization[MAX_NAME_LENGTH];
+        int specialization_id; // index into specializations[], -1 for colleges
+        unsigned long long open_hours[WEEK_WORDS]; // bit (day * 24 + hour) set when open
     };
 
     struct Graph {
         int num_vertices;
+        int num_colleges; // colleges occupy vertices [0, num_colleges)
         struct Location locations[MAX_LOCATIONS];
         double adjacency_matrix[MAX_LOCATIONS][MAX_LOCATIONS];
     };
 
+    // Strings are kept in the hash table's shared string heap and referenced by
+    // 32-bit offsets. Timings and PIN codes repeat across hospitals, so they are
+    // dictionary encoded. Use the info_*() accessors to read them.
     typedef struct info {
-        char name[MAX_NAME_LENGTH];
-        float rating;
-        char timing[MAX];
-        int fees;
-        char address[MAX_NAME_LENGTH * 2];
+        uint32_t name;     // offset into the string heap
+        uint32_t address;  // offset of the address without its trailing PIN code
+        uint32_t timing;   // index into the timing dictionary
+        uint32_t pin_code; // index into the PIN code dictionary, NO_ENTRY if none
+        float rating;  // NAN if info.txt gives none
+        int32_t fees;  // FEES_UNKNOWN if info.txt gives none
         // New fields for reviews and ratings
-        int num_reviews;
+        int32_t num_reviews;
         float total_rating;
     } info;
 
     struct HashNode {
         struct info info;
-        struct HashNode* next;
+        uint32_t next; // index of the next node in the bucket, NO_ENTRY at the end
+    };
+
+    // Distinct strings of one kind, with an open-addressing index for lookups
+    struct StringDictionary {
+        uint32_t* entries; // string heap offsets
+        uint32_t count;
+        uint32_t capacity;
+        uint32_t* slots;   // entry indices, NO_ENTRY when free
+        uint32_t num_slots;
     };
 
     struct HashTable {
-        struct HashNode* buckets[MAX_LOCATIONS];
+        uint32_t buckets[MAX_LOCATIONS]; // index of the first node, NO_ENTRY if empty
+        struct HashNode* nodes;          // node pool, only grows while info.txt is loaded
+        uint32_t num_nodes;
+        uint32_t node_capacity;
+        char* strings;                   // shared heap of NUL-terminated strings
+        uint32_t strings_size;
+        uint32_t strings_capacity;
+        struct StringDictionary timings;
+        struct StringDictionary pin_codes;
     };
 
     struct Comment {
@@ -53,6 +104,23 @@
     struct Comment comments[MAX_COMMENTS];
     int num_comments = 0;
 
+    // Distinct specializations seen in hospitals.txt, in order of first appearance
+    char specializations[MAX_SPECIALIZATIONS][MAX_NAME_LENGTH];
+    int num_specializations = 0;
+
+    int get_specialization_id(const char* specialization) {
+        for (int i = 0; i < num_specializations; i++) {
+            if (strcmp(specializations[i], specialization) == 0) {
+                return i;
+            }
+        }
+        if (num_specializations >= MAX_SPECIALIZATIONS) {
+            return -1;
+        }
+        strcpy(specializations[num_specializations], specialization);
+        return num_specializations++;
+    }
+
     unsigned int hash(const char* str) {
         unsigned int hash = 5381;
         int c;
@@ -64,55 +132,151 @@
         return hash;
     }
 
-    void insert_hash_node(struct HashTable* hash_table, struct info info) {
-        unsigned int index = hash(info.name) % MAX_LOCATIONS;
+    void init_hash_table(struct HashTable* hash_table) {
+        memset(hash_table, 0, sizeof(struct HashTable));
+        for (int i = 0; i < MAX_LOCATIONS; i++) {
+            hash_table->buckets[i] = NO_ENTRY;
+        }
+    }
+
+    uint32_t store_string(struct HashTable* hash_table, const char* str, size_t length) {
+        while (hash_table->strings_size + length + 1 > hash_table->strings_capacity) {
+            hash_table->strings_capacity = hash_table->strings_capacity == 0 ? 4096 : hash_table->strings_capacity * 2;
+            hash_table->strings = realloc(hash_table->strings, hash_table->strings_capacity);
+        }
+        uint32_t offset = hash_table->strings_size;
+        memcpy(hash_table->strings + offset, str, length);
+        hash_table->strings[offset + length] = '\0';
+        hash_table->strings_size += length + 1;
+        return offset;
+    }
+
+    // Returns the dictionary index of str, adding it on first use
+    uint32_t intern_string(struct HashTable* hash_table, struct StringDictionary* dictionary, const char* str) {
+        if ((dictionary->count + 1) * 2 > dictionary->num_slots) {
+            uint32_t num_slots = dictionary->num_slots == 0 ? 64 : dictionary->num_slots * 2;
+            free(dictionary->slots);
+            dictionary->slots = malloc(num_slots * sizeof(uint32_t));
+            memset(dictionary->slots, 0xff, num_slots * sizeof(uint32_t));
+            dictionary->num_slots = num_slots;
+            for (uint32_t i = 0; i < dictionary->count; i++) {
+                uint32_t slot = hash(hash_table->strings + dictionary->entries[i]) % num_slots;
+                while (dictionary->slots[slot] != NO_ENTRY) {
+                    slot = (slot + 1) % num_slots;
+                }
+                dictionary->slots[slot] = i;
+            }
+        }
+
+        uint32_t slot = hash(str) % dictionary->num_slots;
+        while (dictionary->slots[slot] != NO_ENTRY) {
+            uint32_t index = dictionary->slots[slot];
+            if (strcmp(hash_table->strings + dictionary->entries[index], str) == 0) {
+                return index;
+            }
+            slot = (slot + 1) % dictionary->num_slots;
+        }
+
+        if (dictionary->count == dictionary->capacity) {
+            dictionary->capacity = dictionary->capacity == 0 ? 16 : dictionary->capacity * 2;
+            dictionary->entries = realloc(dictionary->entries, dictionary->capacity * sizeof(uint32_t));
+        }
+        dictionary->entries[dictionary->count] = store_string(hash_table, str, strlen(str));
+        dictionary->slots[slot] = dictionary->count;
+        return dictionary->count++;
+    }
+
+    void insert_hash_node(struct HashTable* hash_table, const char* name, float rating, const char* timing, int fees, const char* address) {
+        unsigned int index = hash(name) % MAX_LOCATIONS;
+
+        if (hash_table->num_nodes == hash_table->node_capacity) {
+            hash_table->node_capacity = hash_table->node_capacity == 0 ? 64 : hash_table->node_capacity * 2;
+            hash_table->nodes = realloc(hash_table->nodes, hash_table->node_capacity * sizeof(struct HashNode));
+        }
+        uint32_t node_index = hash_table->num_nodes++;
+        struct HashNode* new_node = &hash_table->nodes[node_index];
+
+        // Addresses end in a 6-digit PIN code, e.g. "Shivajinagar,411005"
+        size_t address_length = strlen(address);
+        new_node->info.pin_code = NO_ENTRY;
+        if (address_length >= 6 && strspn(address + address_length - 6, "0123456789") == 6) {
+            address_length -= 6;
+            new_node->info.pin_code = intern_string(hash_table, &hash_table->pin_codes, address + address_length);
+        }
 
-        struct HashNode* new_node = malloc(sizeof(struct HashNode));
-        new_node->info = info;
+        new_node->info.name = store_string(hash_table, name, strlen(name));
+        new_node->info.address = store_string(hash_table, address, address_length);
+        new_node->info.timing = intern_string(hash_table, &hash_table->timings, timing);
+        new_node->info.rating = rating;
+        new_node->info.fees = fees;
         new_node->info.num_reviews = 0;
         new_node->info.total_rating = 0.0;
-        new_node->next = NULL;
+        new_node->next = NO_ENTRY;
 
-        if (hash_table->buckets[index] == NULL) {
-            hash_table->buckets[index] = new_node;
+        if (hash_table->buckets[index] == NO_ENTRY) {
+            hash_table->buckets[index] = node_index;
         } else {
-            struct HashNode* current = hash_table->buckets[index];
-            while (current->next != NULL) {
-                current = current->next;
+            struct HashNode* current = &hash_table->nodes[hash_table->buckets[index]];
+            while (current->next != NO_ENTRY) {
+                current = &hash_table->nodes[current->next];
             }
-            current->next = new_node;
+            current->next = node_index;
+        }
+    }
+
+    const char* info_name(struct HashTable* hash_table, struct HashNode* hospital) {
+        return hash_table->strings + hospital->info.name;
+    }
+
+    const char* info_timing(struct HashTable* hash_table, struct HashNode* hospital) {
+        return hash_table->strings + hash_table->timings.entries[hospital->info.timing];
+    }
+
+    // Address without its PIN code; print together with info_pin_code()
+    const char* info_address(struct HashTable* hash_table, struct HashNode* hospital) {
+        return hash_table->strings + hospital->info.address;
+    }
+
+    const char* info_pin_code(struct HashTable* hash_table, struct HashNode* hospital) {
+        if (hospital->info.pin_code == NO_ENTRY) {
+            return "";
         }
+        return hash_table->strings + hash_table->pin_codes.entries[hospital->info.pin_code];
     }
 
     struct HashNode* search_hash_node(struct HashTable* hash_table, const char* name) {
         unsigned int index = hash(name) % MAX_LOCATIONS;
 
-        struct HashNode* current = hash_table->buckets[index];
-        while (current != NULL) {
-            if (strcmp(current->info.name, name) == 0) {
-                return current;
+        uint32_t current = hash_table->buckets[index];
+        while (current != NO_ENTRY) {
+            struct HashNode* node = &hash_table->nodes[current];
+            if (strcmp(info_name(hash_table, node), name) == 0) {
+                return node;
             }
-            current = current->next;
+            current = node->next;
         }
 
         return NULL;
     }
 
-    void print_hospital_info(struct HashNode* hospital) {
+    void print_hospital_info(struct HashTable* hash_table, struct HashNode* hospital) {
         printf("\n");
-        printf("Hospital Name  : %s\n", hospital->info.name);
-        printf("Rating         : %.1f\n", hospital->info.rating);
-        printf("Working hours  : %s\n", hospital->info.timing);
-        printf("Average fees   : %d\n", hospital->info.fees);
-        printf("Address        : %s\n", hospital->info.address);
+        printf("Hospital Name  : %s\n", info_name(hash_table, hospital));
+        if (isnan(hospital->info.rating)) {
+            printf("Rating         : Not available\n");
+        } else {
+            printf("Rating         : %.1f\n", hospital->info.rating);
+        }
+        printf("Working hours  : %s\n", info_timing(hash_table, hospital));
+        if (hospital->info.fees == FEES_UNKNOWN) {
+            printf("Average fees   : Not available\n");
+        } else {
+            printf("Average fees   : %d\n", hospital->info.fees);
+        }
+        printf("Address        : %s%s\n", info_address(hash_table, hospital), info_pin_code(hash_table, hospital));
     }
 
-    double calculate_distance(struct Location loc1, struct Location loc2) {
-        double lat1 = loc1.latitude;
-        double lon1 = loc1.longitude;
-        double lat2 = loc2.latitude;
-        double lon2 = loc2.longitude;
-
+    double haversine_distance(double lat1, double lon1, double lat2, double lon2) {
         double dlat = (lat2 - lat1) * M_PI / 180.0;
         double dlon = (lon2 - lon1) * M_PI / 180.0;
 
@@ -125,6 +289,10 @@
         return distance;
     }
 
+    double calculate_distance(struct Location loc1, struct Location loc2) {
+        return haversine_distance(loc1.latitude, loc1.longitude, loc2.latitude, loc2.longitude);
+    }
+
     int find_nearest_location(double* dist, int* visited, int num_vertices) {
         double min_dist = DBL_MAX;
         int min_index = -1;
@@ -165,6 +333,121 @@
         }
     }
 
+    void set_open_hours(unsigned long long* open_hours, int day, int start, int end) {
+        // end < start means the interval runs past midnight into the next day
+        int length = end > start ? end - start : end + 24 - start;
+        for (int h = 0; h < length; h++) {
+            int slot = (day * 24 + start + h) % HOURS_PER_WEEK;
+            open_hours[slot / 64] |= 1ULL << (slot % 64);
+        }
+    }
+
+    int to_24_hour(int hour, char suffix) {
+        return hour % 12 + (suffix == 'p' ? 12 : 0);
+    }
+
+    // Parses info.timing ("24hrs", "9am_to_8pm", "Morning_10-2pm_Evening_6-10pm", ...)
+    // into a weekly bitmap. The same hours apply to every day. Returns 0 and marks
+    // the hospital as always open when the string cannot be understood.
+    // A "Morning" or "Evening" qualifier gives the start hour its am/pm and keeps
+    // that session within the day, so "Morning_9-1am" reads as 9am to 1pm.
+    int parse_working_hours(const char* timing, unsigned long long* open_hours) {
+        char text[MAX];
+        int n = 0;
+        for (; timing[n] != '\0' && n < MAX - 1; n++) {
+            text[n] = tolower((unsigned char)timing[n]);
+        }
+        text[n] = '\0';
+
+        memset(open_hours, 0, WEEK_WORDS * sizeof(unsigned long long));
+
+        int ranges = 0;
+        if (strncmp(text, "24", 2) != 0) {
+            const char* p = text;
+            char qualifier = 0; // 'a' after "morning", 'p' after "afternoon"/"evening"/"night"
+            while (*p != '\0') {
+                if (!isdigit((unsigned char)*p)) {
+                    if (strncmp(p, "morning", 7) == 0) {
+                        qualifier = 'a';
+                    } else if (strncmp(p, "afternoon", 9) == 0 || strncmp(p, "evening", 7) == 0 || strncmp(p, "night", 5) == 0) {
+                        qualifier = 'p';
+                    }
+                    p++;
+                    continue;
+                }
+
+                // <hour>[am|pm](_to_|-)<hour>(am|pm)
+                char* next;
+                int start = strtol(p, &next, 10);
+                char start_suffix = 0;
+                if ((next[0] == 'a' || next[0] == 'p') && next[1] == 'm') {
+                    start_suffix = next[0];
+                    next += 2;
+                }
+                if (strncmp(next, "_to_", 4) == 0) {
+                    next += 4;
+                } else if (*next == '-') {
+                    next++;
+                } else {
+                    p = next;
+                    continue;
+                }
+                if (!isdigit((unsigned char)*next)) {
+                    p = next;
+                    continue;
+                }
+                int end = strtol(next, &next, 10);
+                if (!((next[0] == 'a' || next[0] == 'p') && next[1] == 'm') || start > 12 || end > 12) {
+                    p = next;
+                    continue;
+                }
+                char end_suffix = next[0];
+                next += 2;
+
+                // "10-2pm" means 10am to 2pm: without a qualifier the start borrows
+                // the end's suffix unless that would put it after the end
+                if (start_suffix == 0 && qualifier != 0) {
+                    start_suffix = qualifier;
+                } else if (start_suffix == 0) {
+                    start_suffix = end_suffix;
+                    if (to_24_hour(start, start_suffix) >= to_24_hour(end, end_suffix)) {
+                        start_suffix = end_suffix == 'a' ? 'p' : 'a';
+                    }
+                }
+
+                int start_hour = to_24_hour(start, start_suffix);
+                int end_hour = to_24_hour(end, end_suffix);
+                if (qualifier != 0 && end_hour <= start_hour) {
+                    // A morning or evening session does not run past midnight,
+                    // so the end's suffix is a slip ("Morning_9-1am")
+                    end_hour = to_24_hour(end, end_suffix == 'a' ? 'p' : 'a');
+                    if (end_hour <= start_hour) {
+                        end_hour = start_hour; // still backwards: skip the session
+                    }
+                }
+                qualifier = 0;
+                if (start_hour != end_hour) {
+                    for (int day = 0; day < 7; day++) {
+                        set_open_hours(open_hours, day, start_hour, end_hour);
+                    }
+                    ranges++;
+                }
+                p = next;
+            }
+        }
+
+        if (ranges == 0) {
+            // Round the clock, or unknown hours: never hide the hospital
+            memset(open_hours, 0xff, WEEK_WORDS * sizeof(unsigned long long));
+        }
+        return ranges > 0 || strncmp(text, "24", 2) == 0;
+    }
+
+    // open_hour is an hour of the week (day * 24 + hour), or -1 for any time
+    bool is_open_at(struct Location* location, int open_hour) {
+        return open_hour < 0 || (location->open_hours[open_hour / 64] >> (open_hour % 64)) & 1;
+    }
+
     int find_location_index(struct Graph* graph, const char* location_name) {
         for (int i = 0; i < graph->num_vertices; i++) {
             if (strcmp(graph->locations[i].name, location_name) == 0) {
@@ -188,7 +471,7 @@
         return min_vertex;
     }
 
-    void find_nearest_hospitals(struct Graph* graph, int source, double max_distance, const char* specialization, struct HashTable* hash_table) {
+    void find_nearest_hospitals(struct Graph* graph, int source, double max_distance, const char* specialization, int open_hour, struct HashTable* hash_table) {
         int num_vertices = graph->num_vertices;
         double dist[MAX_LOCATIONS];
         int prev[MAX_LOCATIONS];
@@ -199,6 +482,9 @@
 
         printf("_____________________________________________________________________________________________________\n\n");
         printf("\n\nHospitals within %.2lf km of %s with specialization '%s'\n", max_distance, graph->locations[source].name, specialization);
+        if (open_hour >= 0) {
+            printf("Open at %02d:00\n", open_hour % 24);
+        }
         printf("\n\n_____________________________________________________________________________________________________\n\n");
         printf("Finding nearest hospitals...\n");
         printf("_____________________________________________________________________________________________________\n\n");
@@ -206,7 +492,8 @@
         for (int v = 0; v < num_vertices; v++) {
             if (v != source) {
                 double distance = dist[v];
-                if (distance <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0) {
+                if (distance <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0 &&
+                    is_open_at(&graph->locations[v], open_hour)) {
                     printf("%s  ==>  Distance: %.2lf km\n", graph->locations[v].name, distance);
                     hospital_count++;
                 }
@@ -230,7 +517,7 @@
     }
 
 
-    void details(struct Graph* graph, int source, double max_distance, const char* specialization, struct HashTable* hash_table) {
+    void details(struct Graph* graph, int source, double max_distance, const char* specialization, int open_hour, struct HashTable* hash_table) {
         int num_vertices = graph->num_vertices;
         double dist[MAX_LOCATIONS];
         int prev[MAX_LOCATIONS];
@@ -244,7 +531,8 @@
         for (int v = 0; v < num_vertices; v++) {
             if (v != source) {
                 double distance = dist[v];
-                if (distance <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0) {
+                if (distance <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0 &&
+                    is_open_at(&graph->locations[v], open_hour)) {
                     hospital_count++;
                     arr[v] = graph->locations[v].name;
                     if (hospital_count == 5) {
@@ -255,12 +543,13 @@
         }
 
         for (int v = 0; v < graph->num_vertices; v++) {
-            if (dist[v] <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0) {
+            if (dist[v] <= max_distance && strcmp(graph->locations[v].specialization, specialization) == 0 &&
+                is_open_at(&graph->locations[v], open_hour)) {
                 hospital_count++;
 
                 struct HashNode* hospital_info = search_hash_node(hash_table, graph->locations[v].name);
                 if (hospital_info != NULL) {
-                    print_hospital_info(hospital_info);
+                    print_hospital_info(hash_table, hospital_info);
                     // printf("Rating: %.1f\n", hospital_info->info.rating);
                     // printf("Total Reviews: %d\n", hospital_info->info.num_reviews);
                     printf("\n======================================================================================================\n\n");
@@ -273,6 +562,379 @@
         }
     }
 
+    // Per-vertex list of the k nearest hospitals found so far, sorted by distance.
+    // The first num_settled entries are final, the rest are still tentative.
+    struct NearestLabels {
+        double dist[MAX_NEAREST];
+        int source[MAX_NEAREST];
+        int num_labels;
+        int num_settled;
+    };
+
+    void offer_nearest_label(struct NearestLabels* labels, int k, double distance, int source) {
+        for (int i = 0; i < labels->num_labels; i++) {
+            if (labels->source[i] == source) {
+                if (i < labels->num_settled || distance >= labels->dist[i]) {
+                    return;
+                }
+                // Drop the worse label for this hospital, it is re-inserted below
+                for (int j = i; j < labels->num_labels - 1; j++) {
+                    labels->dist[j] = labels->dist[j + 1];
+                    labels->source[j] = labels->source[j + 1];
+                }
+                labels->num_labels--;
+                break;
+            }
+        }
+
+        if (labels->num_labels == k && distance >= labels->dist[k - 1]) {
+            return;
+        }
+
+        int pos = labels->num_labels < k ? labels->num_labels : k - 1;
+        while (pos > labels->num_settled && labels->dist[pos - 1] > distance) {
+            labels->dist[pos] = labels->dist[pos - 1];
+            labels->source[pos] = labels->source[pos - 1];
+            pos--;
+        }
+        labels->dist[pos] = distance;
+        labels->source[pos] = source;
+        if (labels->num_labels < k) {
+            labels->num_labels++;
+        }
+    }
+
+    // Multi-source Dijkstra seeded with every hospital of one specialization.
+    // Each vertex is settled at most k times, once per distinct hospital, so a
+    // single sweep yields the k nearest hospitals of that specialization for
+    // every college at the cost of about k single-source runs. Hospitals closed
+    // at open_hour (-1 for any time) are not seeded.
+    void nearest_hospitals_sweep(struct Graph* graph, int specialization_id, int k, int open_hour, struct NearestLabels* labels) {
+        int num_vertices = graph->num_vertices;
+
+        for (int v = 0; v < num_vertices; v++) {
+            labels[v].num_labels = 0;
+            labels[v].num_settled = 0;
+        }
+        for (int v = graph->num_colleges; v < num_vertices; v++) {
+            if (graph->locations[v].specialization_id == specialization_id &&
+                is_open_at(&graph->locations[v], open_hour)) {
+                offer_nearest_label(&labels[v], k, 0.0, v);
+            }
+        }
+
+        while (1) {
+            double min_dist = DBL_MAX;
+            int u = -1;
+            for (int v = 0; v < num_vertices; v++) {
+                if (labels[v].num_settled < labels[v].num_labels &&
+                    labels[v].dist[labels[v].num_settled] < min_dist) {
+                    min_dist = labels[v].dist[labels[v].num_settled];
+                    u = v;
+                }
+            }
+            if (u == -1) {
+                break;
+            }
+
+            int source = labels[u].source[labels[u].num_settled];
+            labels[u].num_settled++;
+
+            for (int v = 0; v < num_vertices; v++) {
+                if (v != u && graph->adjacency_matrix[u][v] != 0 && labels[v].num_settled < k) {
+                    offer_nearest_label(&labels[v], k, min_dist + graph->adjacency_matrix[u][v], source);
+                }
+            }
+        }
+    }
+
+    void export_nearest_hospitals(struct Graph* graph, int k, int open_hour, const char* filename) {
+        if (k < 1 || k > MAX_NEAREST) {
+            printf("Number of hospitals must be between 1 and %d.\n", MAX_NEAREST);
+            return;
+        }
+
+        FILE* file = fopen(filename, "w");
+        if (file == NULL) {
+            printf("Error opening file for writing.\n");
+            return;
+        }
+
+        static struct NearestLabels labels[MAX_SPECIALIZATIONS][MAX_LOCATIONS];
+        for (int s = 0; s < num_specializations; s++) {
+            nearest_hospitals_sweep(graph, s, k, open_hour, labels[s]);
+        }
+
+        fprintf(file, "college,specialization,rank,hospital,distance_km\n");
+        int rows = 0;
+        for (int c = 0; c < graph->num_colleges; c++) {
+            for (int s = 0; s < num_specializations; s++) {
+                struct NearestLabels* college_labels = &labels[s][c];
+                for (int r = 0; r < college_labels->num_settled; r++) {
+                    fprintf(file, "%s,%s,%d,%s,%.2lf\n", graph->locations[c].name, specializations[s], r + 1,
+                            graph->locations[college_labels->source[r]].name, college_labels->dist[r]);
+                    rows++;
+                }
+            }
+        }
+
+        fclose(file);
+        printf("Wrote %d rows for %d colleges and %d specializations to %s\n", rows, graph->num_colleges, num_specializations, filename);
+    }
+
+
+    // Column-oriented copy of the searchable hospital attributes, indexed by
+    // vertex. Numeric columns are stored as double so they share one scan loop.
+    // Unknown fees and ratings are NAN, which fails every comparison, so a
+    // hospital with no data never matches a fees or rating predicate.
+    struct HospitalColumns {
+        int num_rows;
+        double fees[MAX_LOCATIONS];
+        double rating[MAX_LOCATIONS];
+        double distance[MAX_LOCATIONS];
+        unsigned int specialization_mask[MAX_LOCATIONS]; // 1 << specialization_id, 0 for colleges
+    };
+
+    enum FilterColumn { COLUMN_FEES, COLUMN_RATING, COLUMN_DISTANCE, COLUMN_SPECIALIZATION, COLUMN_OPEN };
+    enum FilterOp { OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ };
+
+    struct Predicate {
+        enum FilterColumn column;
+        enum FilterOp op;
+        double value;
+        unsigned int mask; // specialization predicates only
+    };
+
+    void build_hospital_columns(struct Graph* graph, struct HashTable* hash_table, struct HospitalColumns* columns) {
+        columns->num_rows = graph->num_vertices;
+        for (int v = 0; v < graph->num_vertices; v++) {
+            struct HashNode* hospital_info = v >= graph->num_colleges ? search_hash_node(hash_table, graph->locations[v].name) : NULL;
+            columns->fees[v] = hospital_info != NULL && hospital_info->info.fees != FEES_UNKNOWN ? hospital_info->info.fees : NAN;
+            columns->rating[v] = hospital_info != NULL ? hospital_info->info.rating : NAN;
+            columns->distance[v] = DBL_MAX;
+            int id = graph->locations[v].specialization_id;
+            columns->specialization_mask[v] = id >= 0 ? 1u << id : 0;
+        }
+    }
+
+    // ANDs (column[i] op value) into bitmap. Each word is built with branch-free
+    // comparisons so the inner loop vectorizes; empty words are skipped.
+    void filter_numeric_column(const double* column, int num_rows, enum FilterOp op, double value, unsigned long long* bitmap) {
+        for (int w = 0; w * 64 < num_rows; w++) {
+            if (bitmap[w] == 0) {
+                continue;
+            }
+            int base = w * 64;
+            int count = num_rows - base < 64 ? num_rows - base : 64;
+            unsigned long long bits = 0;
+            switch (op) {
+                case OP_LT: for (int i = 0; i < count; i++) bits |= (unsigned long long)(column[base + i] < value) << i; break;
+                case OP_LE: for (int i = 0; i < count; i++) bits |= (unsigned long long)(column[base + i] <= value) << i; break;
+                case OP_GT: for (int i = 0; i < count; i++) bits |= (unsigned long long)(column[base + i] > value) << i; break;
+                case OP_GE: for (int i = 0; i < count; i++) bits |= (unsigned long long)(column[base + i] >= value) << i; break;
+                case OP_EQ: for (int i = 0; i < count; i++) bits |= (unsigned long long)(column[base + i] == value) << i; break;
+            }
+            bitmap[w] &= bits;
+        }
+    }
+
+    void filter_mask_column(const unsigned int* column, int num_rows, unsigned int mask, unsigned long long* bitmap) {
+        for (int w = 0; w * 64 < num_rows; w++) {
+            if (bitmap[w] == 0) {
+                continue;
+            }
+            int base = w * 64;
+            int count = num_rows - base < 64 ? num_rows - base : 64;
+            unsigned long long bits = 0;
+            for (int i = 0; i < count; i++) {
+                bits |= (unsigned long long)((column[base + i] & mask) != 0) << i;
+            }
+            bitmap[w] &= bits;
+        }
+    }
+
+    void filter_open_column(struct Graph* graph, int open_hour, unsigned long long* bitmap) {
+        int word = open_hour / 64;
+        unsigned long long bit = 1ULL << (open_hour % 64);
+        for (int w = 0; w * 64 < graph->num_vertices; w++) {
+            if (bitmap[w] == 0) {
+                continue;
+            }
+            int base = w * 64;
+            int count = graph->num_vertices - base < 64 ? graph->num_vertices - base : 64;
+            unsigned long long bits = 0;
+            for (int i = 0; i < count; i++) {
+                bits |= (unsigned long long)((graph->locations[base + i].open_hours[word] & bit) != 0) << i;
+            }
+            bitmap[w] &= bits;
+        }
+    }
+
+    // Parses one "<column><op><value>" term, e.g. "fees<500" or "spec=DENTAL".
+    // Returns 0 for an unknown column, operator or specialization.
+    int parse_predicate(const char* term, struct Predicate* predicate) {
+        const char* columns[] = {"fees", "rating", "dist", "spec", "open"};
+        size_t name_length = strcspn(term, "<>=");
+        predicate->column = -1;
+        for (int i = 0; i < (int)(sizeof(columns) / sizeof(columns[0])); i++) {
+            if (strlen(columns[i]) == name_length && strncmp(term, columns[i], name_length) == 0) {
+                predicate->column = i;
+            }
+        }
+        if ((int)predicate->column == -1) {
+            return 0;
+        }
+
+        const char* op = term + name_length;
+        const char* value = op + 1;
+        if (op[0] == '<' && op[1] == '=') {
+            predicate->op = OP_LE;
+            value++;
+        } else if (op[0] == '>' && op[1] == '=') {
+            predicate->op = OP_GE;
+            value++;
+        } else if (op[0] == '<') {
+            predicate->op = OP_LT;
+        } else if (op[0] == '>') {
+            predicate->op = OP_GT;
+        } else if (op[0] == '=') {
+            predicate->op = OP_EQ;
+        } else {
+            return 0;
+        }
+
+        if (predicate->column == COLUMN_SPECIALIZATION) {
+            predicate->mask = 0;
+            for (int s = 0; s < num_specializations; s++) {
+                if (strcmp(specializations[s], value) == 0) {
+                    predicate->mask = 1u << s;
+                }
+            }
+            return predicate->op == OP_EQ && predicate->mask != 0;
+        }
+
+        char* end;
+        predicate->value = strtod(value, &end);
+        if (end == value || *end != '\0') {
+            return 0;
+        }
+        if (predicate->column == COLUMN_OPEN) {
+            return predicate->op == OP_EQ && predicate->value >= 0 && predicate->value < 24;
+        }
+        return 1;
+    }
+
+    // qsort() has no context argument, so the sort key is passed through here
+    const double* sort_column;
+    int sort_descending;
+
+    // Unknown (NAN) values sort last in either direction
+    int compare_by_sort_column(const void* a, const void* b) {
+        double va = sort_column[*(const int*)a];
+        double vb = sort_column[*(const int*)b];
+        if (isnan(va) || isnan(vb)) {
+            return (isnan(va) != 0) - (isnan(vb) != 0);
+        }
+        int order = (va > vb) - (va < vb);
+        return sort_descending ? -order : order;
+    }
+
+    // Runs a query such as "dist<=5 fees<500 rating>=4.0 spec=MULTISPECIALITY open=21 sort=-rating".
+    // The distance step narrows the candidate bitmap first, then every other
+    // predicate is intersected into it with a column scan.
+    void filter_hospitals(struct Graph* graph, struct HospitalColumns* columns, int source, const char* query) {
+        struct Predicate predicates[16];
+        int num_predicates = 0;
+        const double* order_by = columns->distance;
+        int descending = 0;
+
+        char terms[MAX_NAME_LENGTH];
+        strncpy(terms, query, sizeof(terms) - 1);
+        terms[sizeof(terms) - 1] = '\0';
+        for (char* term = strtok(terms, " \t"); term != NULL; term = strtok(NULL, " \t")) {
+            if (strncmp(term, "sort=", 5) == 0) {
+                const char* key = term + 5;
+                descending = *key == '-';
+                key += descending;
+                if (strcmp(key, "fees") == 0) {
+                    order_by = columns->fees;
+                } else if (strcmp(key, "rating") == 0) {
+                    order_by = columns->rating;
+                } else if (strcmp(key, "dist") == 0) {
+                    order_by = columns->distance;
+                } else {
+                    printf("Unknown sort column '%s'.\n", key);
+                    return;
+                }
+            } else if (num_predicates < 16 && parse_predicate(term, &predicates[num_predicates])) {
+                num_predicates++;
+            } else {
+                printf("Invalid filter '%s'.\n", term);
+                return;
+            }
+        }
+
+        double dist[MAX_LOCATIONS];
+        int prev[MAX_LOCATIONS];
+        dijkstra(graph, source, dist, prev);
+        memcpy(columns->distance, dist, graph->num_vertices * sizeof(double));
+
+        // Candidates start as every hospital vertex
+        unsigned long long bitmap[(MAX_LOCATIONS + 63) / 64] = {0};
+        for (int v = graph->num_colleges; v < graph->num_vertices; v++) {
+            bitmap[v / 64] |= 1ULL << (v % 64);
+        }
+
+        for (int p = 0; p < num_predicates; p++) {
+            if (predicates[p].column == COLUMN_DISTANCE) {
+                filter_numeric_column(columns->distance, columns->num_rows, predicates[p].op, predicates[p].value, bitmap);
+            }
+        }
+        for (int p = 0; p < num_predicates; p++) {
+            struct Predicate* predicate = &predicates[p];
+            if (predicate->column == COLUMN_FEES) {
+                filter_numeric_column(columns->fees, columns->num_rows, predicate->op, predicate->value, bitmap);
+            } else if (predicate->column == COLUMN_RATING) {
+                filter_numeric_column(columns->rating, columns->num_rows, predicate->op, predicate->value, bitmap);
+            } else if (predicate->column == COLUMN_SPECIALIZATION) {
+                filter_mask_column(columns->specialization_mask, columns->num_rows, predicate->mask, bitmap);
+            } else if (predicate->column == COLUMN_OPEN) {
+                time_t now = time(NULL);
+                filter_open_column(graph, localtime(&now)->tm_wday * 24 + (int)predicate->value, bitmap);
+            }
+        }
+
+        int matches[MAX_LOCATIONS];
+        int num_matches = 0;
+        for (int w = 0; w * 64 < columns->num_rows; w++) {
+            for (unsigned long long bits = bitmap[w]; bits != 0; bits &= bits - 1) {
+                matches[num_matches++] = w * 64 + __builtin_ctzll(bits);
+            }
+        }
+
+        sort_column = order_by;
+        sort_descending = descending;
+        qsort(matches, num_matches, sizeof(int), compare_by_sort_column);
+
+        printf("\n%-40s %10s %8s %8s  %s\n", "Hospital", "Distance", "Fees", "Rating", "Specialization");
+        for (int i = 0; i < num_matches; i++) {
+            int v = matches[i];
+            char fees[16] = "n/a";
+            char rating[16] = "n/a";
+            if (!isnan(columns->fees[v])) {
+                snprintf(fees, sizeof(fees), "%.0lf", columns->fees[v]);
+            }
+            if (!isnan(columns->rating[v])) {
+                snprintf(rating, sizeof(rating), "%.1lf", columns->rating[v]);
+            }
+            printf("%-40s %7.2lf km %8s %8s  %s\n", graph->locations[v].name, columns->distance[v],
+                   fees, rating, graph->locations[v].specialization);
+        }
+        if (num_matches == 0) {
+            printf("No hospitals match the filters.\n");
+        }
+    }
+
 
     void save_reviews_to_file(struct HashTable* hash_table, const char* filename) {
         FILE* file = fopen(filename, "w");
@@ -282,12 +944,13 @@
         }
 
         for (int i = 0; i < MAX_LOCATIONS; i++) {
-            struct HashNode* current = hash_table->buckets[i];
-            while (current != NULL) {
-                if (current->info.num_reviews > 0) {
-                    fprintf(file, "%s;%d;%f;%f\n", current->info.name, current->info.num_reviews, current->info.total_rating, current->info.rating);
+            uint32_t current = hash_table->buckets[i];
+            while (current != NO_ENTRY) {
+                struct HashNode* node = &hash_table->nodes[current];
+                if (node->info.num_reviews > 0) {
+                    fprintf(file, "%s;%d;%f;%f\n", info_name(hash_table, node), node->info.num_reviews, node->info.total_rating, node->info.rating);
                 }
-                current = current->next;
+                current = node->next;
             }
         }
 
@@ -348,12 +1011,20 @@
             struct HashNode* hospital_info_node = search_hash_node(hash_table, hospital_name);
 
             if (hospital_info_node != NULL) {
-                printf("\nHospital Name  : %s\n", hospital_info_node->info.name);
-                printf("Rating         : %.1f\n", hospital_info_node->info.rating);
+                printf("\nHospital Name  : %s\n", info_name(hash_table, hospital_info_node));
+                if (isnan(hospital_info_node->info.rating)) {
+                    printf("Rating         : Not available\n");
+                } else {
+                    printf("Rating         : %.1f\n", hospital_info_node->info.rating);
+                }
                 printf("Total Reviews  : %d\n", hospital_info_node->info.num_reviews);
-                printf("Working hours  : %s\n", hospital_info_node->info.timing);
-                printf("Average fees   : %d\n", hospital_info_node->info.fees);
-                printf("Address        : %s\n", hospital_info_node->info.address);
+                printf("Working hours  : %s\n", info_timing(hash_table, hospital_info_node));
+                if (hospital_info_node->info.fees == FEES_UNKNOWN) {
+                    printf("Average fees   : Not available\n");
+                } else {
+                    printf("Average fees   : %d\n", hospital_info_node->info.fees);
+                }
+                printf("Address        : %s%s\n", info_address(hash_table, hospital_info_node), info_pin_code(hash_table, hospital_info_node));
 
                 printf("\nLeave a Review (1-5): ");
                 int user_rating;
@@ -402,67 +1073,378 @@
         fclose(file);
     }
 
-void add_comment(struct Comment* comments, int* num_comments, const char* hospital_name, const char* user_name, const char* text) {
-    if (*num_comments >= MAX_COMMENTS) {
-        printf("Comments limit reached.\n");
-        return;
-    }
-
-    struct Comment new_comment;
-    strcpy(new_comment.hospital_name, hospital_name);
-    strcpy(new_comment.user_name, user_name);
-    strcpy(new_comment.text, text);
+    // Inverted index over Comment.text. Comments are identified by their line
+    // number in comments.txt and postings are kept in ascending order. The log
+    // stays the source of truth: comments.idx is a checkpoint covering the
+    // first indexed_bytes of the log, and anything appended later is indexed
+    // when the index is opened.
+    struct PostingList {
+        uint32_t* ids;
+        uint32_t count;
+        uint32_t capacity;
+    };
 
-    comments[(*num_comments)++] = new_comment;
+    struct CommentIndex {
+        char** tokens;
+        struct PostingList* postings; // postings[i] lists the comments containing tokens[i]
+        uint32_t num_tokens;
+        uint32_t token_capacity;
+        uint32_t* slots;              // open-addressing table of token numbers, NO_ENTRY when free
+        uint32_t num_slots;
+        long* offsets;                // byte offset of each comment line in the log
+        uint32_t num_comments;
+        uint32_t comment_capacity;
+        long indexed_bytes;
+        unsigned int last_line_hash;  // detects a log rewritten behind the index's back
+    };
 
-    // Open the file in append mode with error checking
-    FILE* file = fopen("comments.txt", "a");
-    if (file == NULL) {
-        printf("Error opening file for appending comments.\n");
-        return;
-    }
+    struct CommentIndex comment_index;
 
-    // Write the new comment to the file with error checking
-    if (fprintf(file, "%s;%s;%s\n", hospital_name, user_name, text) < 0) {
-        printf("Error writing to comments file.\n");
+    void free_comment_index(struct CommentIndex* index) {
+        for (uint32_t i = 0; i < index->num_tokens; i++) {
+            free(index->tokens[i]);
+            free(index->postings[i].ids);
+        }
+        free(index->tokens);
+        free(index->postings);
+        free(index->slots);
+        free(index->offsets);
+        memset(index, 0, sizeof(struct CommentIndex));
     }
 
-    fclose(file);
-
-    printf("Comment added successfully!\n");
-}
-
-void display_comments(struct Comment* comments, int num_comments, const char* hospital_name) {
-    printf("Comments for Hospital: %s\n", hospital_name);
+    // Returns the token's number, adding it when `create` is set (NO_ENTRY otherwise)
+    uint32_t find_token(struct CommentIndex* index, const char* token, bool create) {
+        if (create && (index->num_tokens + 1) * 2 > index->num_slots) {
+            uint32_t num_slots = index->num_slots == 0 ? 1024 : index->num_slots * 2;
+            free(index->slots);
+            index->slots = malloc(num_slots * sizeof(uint32_t));
+            memset(index->slots, 0xff, num_slots * sizeof(uint32_t));
+            index->num_slots = num_slots;
+            for (uint32_t i = 0; i < index->num_tokens; i++) {
+                uint32_t slot = hash(index->tokens[i]) % num_slots;
+                while (index->slots[slot] != NO_ENTRY) {
+                    slot = (slot + 1) % num_slots;
+                }
+                index->slots[slot] = i;
+            }
+        }
+        if (index->num_slots == 0) {
+            return NO_ENTRY;
+        }
 
-    int found_comments = 0;
+        uint32_t slot = hash(token) % index->num_slots;
+        while (index->slots[slot] != NO_ENTRY) {
+            if (strcmp(index->tokens[index->slots[slot]], token) == 0) {
+                return index->slots[slot];
+            }
+            slot = (slot + 1) % index->num_slots;
+        }
+        if (!create) {
+            return NO_ENTRY;
+        }
 
-    for (int i = 0; i < num_comments; i++) {
-        if (strcmp(comments[i].hospital_name, hospital_name) == 0) {
-            printf("User: %s\n", comments[i].user_name);
-            printf("Comment: %s\n\n", comments[i].text);
-            found_comments = 1;
+        if (index->num_tokens == index->token_capacity) {
+            index->token_capacity = index->token_capacity == 0 ? 256 : index->token_capacity * 2;
+            index->tokens = realloc(index->tokens, index->token_capacity * sizeof(char*));
+            index->postings = realloc(index->postings, index->token_capacity * sizeof(struct PostingList));
         }
+        uint32_t id = index->num_tokens++;
+        index->tokens[id] = strdup(token);
+        index->postings[id].ids = NULL;
+        index->postings[id].count = 0;
+        index->postings[id].capacity = 0;
+        index->slots[slot] = id;
+        return id;
     }
 
-    if (!found_comments) {
-        printf("No comments available for this hospital.\n");
+    // Splits text into lowercase alphanumeric words. Returns the number of
+    // tokens written to `tokens`; longer words are cut to MAX_TOKEN_LENGTH - 1.
+    int tokenize(const char* text, char tokens[][MAX_TOKEN_LENGTH], int max_tokens) {
+        int count = 0;
+        while (*text != '\0' && count < max_tokens) {
+            if (!isalnum((unsigned char)*text)) {
+                text++;
+                continue;
+            }
+            int length = 0;
+            while (isalnum((unsigned char)*text)) {
+                if (length < MAX_TOKEN_LENGTH - 1) {
+                    tokens[count][length++] = tolower((unsigned char)*text);
+                }
+                text++;
+            }
+            tokens[count][length] = '\0';
+            count++;
+        }
+        return count;
     }
 
-    // Load comments from the file and store them in the file_comments array
-    FILE* file = fopen("comments.txt", "r");
-    if (file == NULL) {
-        printf("Error opening file for reading comments.\n");
-        return;
-    }
+    // Indexes one comment line that starts at `offset` in the log
+    void index_comment(struct CommentIndex* index, long offset, const char* line) {
+        if (index->num_comments == index->comment_capacity) {
+            index->comment_capacity = index->comment_capacity == 0 ? 1024 : index->comment_capacity * 2;
+            index->offsets = realloc(index->offsets, index->comment_capacity * sizeof(long));
+        }
+        uint32_t id = index->num_comments++;
+        index->offsets[id] = offset;
+        index->indexed_bytes = offset + strlen(line);
+        index->last_line_hash = hash(line);
 
-    char line[MAX_NAME_LENGTH * 4];
-    while (fgets(line, sizeof(line), file)) {
-        char stored_hospital_name[MAX_NAME_LENGTH];
+        char hospital_name[MAX_NAME_LENGTH];
         char user_name[MAX_NAME_LENGTH];
         char text[MAX_NAME_LENGTH * 2];
-        sscanf(line, "%[^;];%[^;];%[^\n]", stored_hospital_name, user_name, text);
-
+        if (sscanf(line, "%[^;];%[^;];%[^\n]", hospital_name, user_name, text) != 3) {
+            return;
+        }
+
+        char tokens[MAX_NAME_LENGTH][MAX_TOKEN_LENGTH];
+        int num_tokens = tokenize(text, tokens, MAX_NAME_LENGTH);
+        for (int i = 0; i < num_tokens; i++) {
+            uint32_t token_id = find_token(index, tokens[i], true); // may grow postings
+            struct PostingList* list = &index->postings[token_id];
+            if (list->count > 0 && list->ids[list->count - 1] == id) {
+                continue; // Word repeated within this comment
+            }
+            if (list->count == list->capacity) {
+                list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+                list->ids = realloc(list->ids, list->capacity * sizeof(uint32_t));
+            }
+            list->ids[list->count++] = id;
+        }
+    }
+
+    void save_comment_index(struct CommentIndex* index, const char* filename) {
+        FILE* file = fopen(filename, "wb");
+        if (file == NULL) {
+            printf("Error opening file for writing comment index.\n");
+            return;
+        }
+        fwrite(&index->indexed_bytes, sizeof(long), 1, file);
+        fwrite(&index->last_line_hash, sizeof(unsigned int), 1, file);
+        fwrite(&index->num_comments, sizeof(uint32_t), 1, file);
+        fwrite(index->offsets, sizeof(long), index->num_comments, file);
+        fwrite(&index->num_tokens, sizeof(uint32_t), 1, file);
+        for (uint32_t i = 0; i < index->num_tokens; i++) {
+            uint32_t length = strlen(index->tokens[i]);
+            fwrite(&length, sizeof(uint32_t), 1, file);
+            fwrite(index->tokens[i], 1, length, file);
+            fwrite(&index->postings[i].count, sizeof(uint32_t), 1, file);
+            fwrite(index->postings[i].ids, sizeof(uint32_t), index->postings[i].count, file);
+        }
+        fclose(file);
+    }
+
+    int load_comment_index(struct CommentIndex* index, const char* filename) {
+        FILE* file = fopen(filename, "rb");
+        if (file == NULL) {
+            return 0;
+        }
+
+        uint32_t num_comments, num_tokens;
+        int ok = fread(&index->indexed_bytes, sizeof(long), 1, file) == 1 &&
+                 fread(&index->last_line_hash, sizeof(unsigned int), 1, file) == 1 &&
+                 fread(&num_comments, sizeof(uint32_t), 1, file) == 1;
+        if (ok) {
+            index->offsets = malloc((num_comments > 0 ? num_comments : 1) * sizeof(long));
+            index->num_comments = num_comments;
+            index->comment_capacity = num_comments;
+            ok = fread(index->offsets, sizeof(long), num_comments, file) == num_comments &&
+                 fread(&num_tokens, sizeof(uint32_t), 1, file) == 1;
+        }
+        for (uint32_t i = 0; ok && i < num_tokens; i++) {
+            char token[MAX_TOKEN_LENGTH];
+            uint32_t length, count;
+            ok = fread(&length, sizeof(uint32_t), 1, file) == 1 && length < MAX_TOKEN_LENGTH &&
+                 fread(token, 1, length, file) == length &&
+                 fread(&count, sizeof(uint32_t), 1, file) == 1;
+            if (!ok) {
+                break;
+            }
+            token[length] = '\0';
+            uint32_t token_id = find_token(index, token, true);
+            struct PostingList* list = &index->postings[token_id];
+            list->ids = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+            list->capacity = count;
+            list->count = count;
+            ok = fread(list->ids, sizeof(uint32_t), count, file) == count;
+        }
+        fclose(file);
+
+        if (!ok) {
+            free_comment_index(index);
+        }
+        return ok;
+    }
+
+    // Loads the saved index and brings it up to date with the comment log
+    void open_comment_index(struct CommentIndex* index, const char* log_filename) {
+        FILE* log = fopen(log_filename, "r");
+        if (log == NULL) {
+            return;
+        }
+
+        if (load_comment_index(index, COMMENT_INDEX_FILE) && index->num_comments > 0) {
+            // Start over if the log shrank or its last indexed line changed
+            char line[MAX_NAME_LENGTH * 4] = "";
+            fseek(log, 0, SEEK_END);
+            if (ftell(log) < index->indexed_bytes ||
+                fseek(log, index->offsets[index->num_comments - 1], SEEK_SET) != 0 ||
+                fgets(line, sizeof(line), log) == NULL || hash(line) != index->last_line_hash) {
+                free_comment_index(index);
+            }
+        }
+
+        fseek(log, index->indexed_bytes, SEEK_SET);
+        long offset = index->indexed_bytes;
+        char line[MAX_NAME_LENGTH * 4];
+        while (fgets(line, sizeof(line), log)) {
+            index_comment(index, offset, line);
+            offset = ftell(log);
+        }
+        fclose(log);
+    }
+
+    int compare_posting_counts(const void* a, const void* b) {
+        uint32_t ca = (*(struct PostingList* const*)a)->count;
+        uint32_t cb = (*(struct PostingList* const*)b)->count;
+        return (ca > cb) - (ca < cb);
+    }
+
+    // Prints the comments containing every word of the query
+    void search_comments(struct CommentIndex* index, const char* log_filename, const char* query) {
+        char tokens[MAX_NAME_LENGTH][MAX_TOKEN_LENGTH];
+        int num_tokens = tokenize(query, tokens, MAX_NAME_LENGTH);
+        if (num_tokens == 0) {
+            printf("Please enter at least one word to search for.\n");
+            return;
+        }
+
+        struct PostingList* lists[MAX_NAME_LENGTH];
+        for (int i = 0; i < num_tokens; i++) {
+            uint32_t id = find_token(index, tokens[i], false);
+            if (id == NO_ENTRY) {
+                printf("No comments found for \"%s\".\n", query);
+                return;
+            }
+            lists[i] = &index->postings[id];
+        }
+
+        // Intersect starting from the rarest word so the candidate set only shrinks
+        qsort(lists, num_tokens, sizeof(struct PostingList*), compare_posting_counts);
+        uint32_t* matches = malloc((lists[0]->count > 0 ? lists[0]->count : 1) * sizeof(uint32_t));
+        uint32_t num_matches = lists[0]->count;
+        memcpy(matches, lists[0]->ids, num_matches * sizeof(uint32_t));
+        for (int i = 1; i < num_tokens && num_matches > 0; i++) {
+            uint32_t kept = 0;
+            uint32_t j = 0;
+            for (uint32_t m = 0; m < num_matches; m++) {
+                while (j < lists[i]->count && lists[i]->ids[j] < matches[m]) {
+                    j++;
+                }
+                if (j < lists[i]->count && lists[i]->ids[j] == matches[m]) {
+                    matches[kept++] = matches[m];
+                }
+            }
+            num_matches = kept;
+        }
+
+        if (num_matches == 0) {
+            printf("No comments found for \"%s\".\n", query);
+            free(matches);
+            return;
+        }
+
+        FILE* log = fopen(log_filename, "r");
+        if (log == NULL) {
+            printf("Error opening file for reading comments.\n");
+            free(matches);
+            return;
+        }
+
+        printf("%u comment(s) found for \"%s\":\n\n", num_matches, query);
+        for (uint32_t m = 0; m < num_matches; m++) {
+            char line[MAX_NAME_LENGTH * 4];
+            char hospital_name[MAX_NAME_LENGTH];
+            char user_name[MAX_NAME_LENGTH];
+            char text[MAX_NAME_LENGTH * 2];
+            fseek(log, index->offsets[matches[m]], SEEK_SET);
+            if (fgets(line, sizeof(line), log) &&
+                sscanf(line, "%[^;];%[^;];%[^\n]", hospital_name, user_name, text) == 3) {
+                printf("Hospital: %s\n", hospital_name);
+                printf("User: %s\n", user_name);
+                printf("Comment: %s\n\n", text);
+            }
+        }
+
+        fclose(log);
+        free(matches);
+    }
+
+void add_comment(struct Comment* comments, int* num_comments, const char* hospital_name, const char* user_name, const char* text) {
+    // Only the in-memory list is limited, the comment log and its index are not
+    if (*num_comments < MAX_COMMENTS) {
+        struct Comment new_comment;
+        strcpy(new_comment.hospital_name, hospital_name);
+        strcpy(new_comment.user_name, user_name);
+        strcpy(new_comment.text, text);
+
+        comments[(*num_comments)++] = new_comment;
+    }
+
+    // Open the file in append mode with error checking
+    FILE* file = fopen("comments.txt", "a");
+    if (file == NULL) {
+        printf("Error opening file for appending comments.\n");
+        return;
+    }
+
+    // Write the new comment to the file with error checking
+    char line[MAX_NAME_LENGTH * 4];
+    snprintf(line, sizeof(line), "%s;%s;%s\n", hospital_name, user_name, text);
+    fseek(file, 0, SEEK_END);
+    long offset = ftell(file);
+    if (fputs(line, file) < 0) {
+        printf("Error writing to comments file.\n");
+    } else {
+        index_comment(&comment_index, offset, line);
+    }
+
+    fclose(file);
+
+    printf("Comment added successfully!\n");
+}
+
+void display_comments(struct Comment* comments, int num_comments, const char* hospital_name) {
+    printf("Comments for Hospital: %s\n", hospital_name);
+
+    int found_comments = 0;
+
+    for (int i = 0; i < num_comments; i++) {
+        if (strcmp(comments[i].hospital_name, hospital_name) == 0) {
+            printf("User: %s\n", comments[i].user_name);
+            printf("Comment: %s\n\n", comments[i].text);
+            found_comments = 1;
+        }
+    }
+
+    if (!found_comments) {
+        printf("No comments available for this hospital.\n");
+    }
+
+    // Load comments from the file and store them in the file_comments array
+    FILE* file = fopen("comments.txt", "r");
+    if (file == NULL) {
+        printf("Error opening file for reading comments.\n");
+        return;
+    }
+
+    char line[MAX_NAME_LENGTH * 4];
+    while (fgets(line, sizeof(line), file)) {
+        char stored_hospital_name[MAX_NAME_LENGTH];
+        char user_name[MAX_NAME_LENGTH];
+        char text[MAX_NAME_LENGTH * 2];
+        sscanf(line, "%[^;];%[^;];%[^\n]", stored_hospital_name, user_name, text);
+
         if (strcmp(stored_hospital_name, hospital_name) == 0) {
             int found_in_comments = 0;
             for (int i = 0; i < num_comments; i++) {
@@ -472,109 +1454,1599 @@ void display_comments(struct Comment* comments, int num_comments, const char* ho
                 }
             }
 
-            if (!found_in_comments) {
-                // This comment from the file is not in the comments array, so add it to the file_comments array
-                struct Comment new_comment;
-                strcpy(new_comment.hospital_name, hospital_name);
-                strcpy(new_comment.user_name, user_name);
-                strcpy(new_comment.text, text);
+            if (!found_in_comments) {
+                // This comment from the file is not in the comments array, so add it to the file_comments array
+                struct Comment new_comment;
+                strcpy(new_comment.hospital_name, hospital_name);
+                strcpy(new_comment.user_name, user_name);
+                strcpy(new_comment.text, text);
+
+                // Display the comment from the file (without "(from file)")
+                printf("User: %s\n", user_name);
+                printf("Comment: %s\n\n", text);
+                found_comments = 1;
+            }
+        }
+    }
+
+    fclose(file);
+
+    if (!found_comments) {
+        // printf("No additional comments available from the file.\n");
+    }
+}
+
+
+void display_hospitals(struct Graph* graph) {
+    printf("\nHospitals Available:\n");
+    int hospital_count = 0;
+    for (int i = 0; i < graph->num_vertices; i++) {
+        int specializationExists = 0;
+        char* L[] = {"GENERAL", "MULTISPECIALITY", "ORTHOPEDIC", "SKIN_AND_HAIR", "PEDIATRICS", "OPHTHALMOLOGY", "DENTAL", "AYURVED", "ENDOSCOPY", "ALLOPATHY","OPTHALMOLOGY"};
+        for (int j = 0; j < sizeof(L) / sizeof(L[0]); j++) {
+            if (strcmp(graph->locations[i].specialization, L[j]) == 0) {
+                specializationExists = 1;
+                break;
+            }
+        }
+        if (specializationExists) {
+            printf("%d. %s\n", hospital_count + 1, graph->locations[i].name);
+            hospital_count += 1;
+        }
+    }
+}
+
+int get_hospital_index(struct Graph* graph, const char* hospital_name) {
+    // Define the list of valid specializations
+    const char* valid_specializations[] = {
+        "GENERAL",
+        "MULTISPECIALITY",
+        "ORTHOPEDIC",
+        "SKIN_AND_HAIR",
+        "PEDIATRICS",
+        "OPHTHALMOLOGY",
+        "DENTAL",
+        "AYURVED",
+        "ENDOSCOPY",
+        "ALLOPATHY",
+        "OPTHALMOLOGY"
+    };
+
+    int num_specializations = sizeof(valid_specializations) / sizeof(valid_specializations[0]);
+
+    for (int i = 0; i < graph->num_vertices; i++) {
+        if (strcmp(graph->locations[i].name, hospital_name) == 0) {
+            // Check if the specialization is valid
+            const char* specialization = graph->locations[i].specialization;
+            int is_valid_specialization = 0;
+
+            for (int j = 0; j < num_specializations; j++) {
+                if (strcmp(specialization, valid_specializations[j]) == 0) {
+                    is_valid_specialization = 1;
+                    break;
+                }
+            }
+
+            if (!is_valid_specialization) {
+                // printf("Invalid Specialization for the Hospital: %s\n", hospital_name);
+                // return -2;
+                // printf("Invalid Hospital");
+                break;
+            }
+
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+
+    // Geographic sharding: hospitals are partitioned by TILE_DEGREES tiles and
+    // each shard process only loads the hospitals of its own tiles. Shards answer
+    // radius queries over a Unix socket with results sorted by distance.
+    int tile_index(double degrees) {
+        return (int)floor(degrees / TILE_DEGREES);
+    }
+
+    int shard_for_tile(int tile_row, int tile_col, int num_shards) {
+        unsigned int key = ((unsigned int)tile_row * 73856093u) ^ ((unsigned int)tile_col * 19349663u);
+        return key % num_shards;
+    }
+
+    // The shard count is part of the path, so a worker started for another
+    // partitioning is never mistaken for the owner of this shard's tiles
+    void shard_socket_path(int shard, int num_shards, char* path, size_t size) {
+        snprintf(path, size, SHARD_SOCKET_FORMAT, shard, num_shards);
+    }
+
+    struct ShardResult {
+        char name[MAX_NAME_LENGTH];
+        double distance;
+    };
+
+    int compare_shard_results(const void* a, const void* b) {
+        double da = ((const struct ShardResult*)a)->distance;
+        double db = ((const struct ShardResult*)b)->distance;
+        return (da > db) - (da < db);
+    }
+
+    int run_shard_worker(int shard, int num_shards) {
+        if (num_shards < 1 || num_shards > MAX_SHARDS || shard < 0 || shard >= num_shards) {
+            printf("Invalid shard %d of %d.\n", shard, num_shards);
+            return 1;
+        }
+
+        FILE* file = fopen("hospitals.txt", "r");
+        if (file == NULL) {
+            printf("Failed to open the hospitals file.\n");
+            return 1;
+        }
+
+        struct Location* hospitals = NULL;
+        int num_hospitals = 0;
+        int capacity = 0;
+        char line[MAX_NAME_LENGTH * 2];
+        while (fgets(line, sizeof(line), file)) {
+            char name[MAX_NAME_LENGTH];
+            double lat, lon;
+            char specialization[MAX_NAME_LENGTH];
+            if (sscanf(line, "%[^;];%lf;%lf;%s", name, &lat, &lon, specialization) != 4) {
+                continue;
+            }
+            if (shard_for_tile(tile_index(lat), tile_index(lon), num_shards) != shard) {
+                continue; // Belongs to another shard
+            }
+
+            if (num_hospitals == capacity) {
+                capacity = capacity == 0 ? 16 : capacity * 2;
+                hospitals = realloc(hospitals, capacity * sizeof(struct Location));
+            }
+            struct Location* location = &hospitals[num_hospitals++];
+            strcpy(location->name, name);
+            location->latitude = lat;
+            location->longitude = lon;
+            strcpy(location->specialization, specialization);
+            location->specialization_id = -1;
+            memset(location->open_hours, 0xff, sizeof(location->open_hours)); // until info.txt says otherwise
+        }
+        fclose(file);
+
+        file = fopen("info.txt", "r");
+        if (file != NULL) {
+            while (fgets(line, sizeof(line), file)) {
+                char name[MAX_NAME_LENGTH];
+                float rating;
+                char timing[MAX_NAME_LENGTH];
+                if (sscanf(line, "%[^;];%f;%[^;]", name, &rating, timing) != 3) {
+                    continue;
+                }
+                for (int i = 0; i < num_hospitals; i++) {
+                    if (strcmp(hospitals[i].name, name) == 0) {
+                        parse_working_hours(timing, hospitals[i].open_hours);
+                        break;
+                    }
+                }
+            }
+            fclose(file);
+        }
+
+        char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+        shard_socket_path(shard, num_shards, path, sizeof(path));
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path);
+        if (server < 0 || bind(server, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 8) < 0) {
+            printf("Shard %d: cannot listen on %s\n", shard, path);
+            free(hospitals);
+            return 1;
+        }
+
+        struct ShardResult* results = malloc((num_hospitals > 0 ? num_hospitals : 1) * sizeof(struct ShardResult));
+        int running = 1;
+        while (running) {
+            int client = accept(server, NULL, NULL);
+            if (client < 0) {
+                continue;
+            }
+            FILE* in = fdopen(client, "r");
+            FILE* out = fdopen(dup(client), "w");
+
+            // Requests are "QUERY;lat;lon;radius_km;specialization;open_hour" or "QUIT",
+            // where open_hour is an hour of the week or -1 for any time
+            while (fgets(line, sizeof(line), in)) {
+                if (strncmp(line, "QUIT", 4) == 0) {
+                    running = 0;
+                    break;
+                }
+
+                double lat, lon, radius;
+                char specialization[MAX_NAME_LENGTH];
+                int open_hour = -1;
+                int count = 0;
+                if (sscanf(line, "QUERY;%lf;%lf;%lf;%[^;\n];%d", &lat, &lon, &radius, specialization, &open_hour) >= 4) {
+                    if (open_hour >= HOURS_PER_WEEK) {
+                        open_hour = -1;
+                    }
+                    for (int i = 0; i < num_hospitals; i++) {
+                        if (strcmp(hospitals[i].specialization, specialization) != 0 ||
+                            !is_open_at(&hospitals[i], open_hour)) {
+                            continue;
+                        }
+                        double distance = haversine_distance(lat, lon, hospitals[i].latitude, hospitals[i].longitude);
+                        if (distance <= radius) {
+                            strcpy(results[count].name, hospitals[i].name);
+                            results[count].distance = distance;
+                            count++;
+                        }
+                    }
+                    qsort(results, count, sizeof(struct ShardResult), compare_shard_results);
+                }
+
+                for (int i = 0; i < count; i++) {
+                    fprintf(out, "%s;%.6lf\n", results[i].name, results[i].distance);
+                }
+                fprintf(out, "END\n");
+                fflush(out);
+            }
+
+            fclose(in);
+            fclose(out);
+        }
+
+        close(server);
+        unlink(path);
+        free(results);
+        free(hospitals);
+        return 0;
+    }
+
+    int connect_to_shard(int shard, int num_shards) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        shard_socket_path(shard, num_shards, addr.sun_path, sizeof(addr.sun_path));
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    int find_college_coordinates(const char* college, double* lat, double* lon) {
+        FILE* file = fopen("colleges.txt", "r");
+        if (file == NULL) {
+            printf("Failed to open the colleges file.\n");
+            return 0;
+        }
+
+        char line[100];
+        int found = 0;
+        while (!found && fgets(line, sizeof(line), file)) {
+            char name[MAX_NAME_LENGTH];
+            if (sscanf(line, "%[^,],%lf,%lf", name, lat, lon) == 3 && strcmp(name, college) == 0) {
+                found = 1;
+            }
+        }
+
+        fclose(file);
+        return found;
+    }
+
+    // Marks every shard owning a tile that intersects the query circle
+    void mark_shards_for_circle(double lat, double lon, double radius, int num_shards, int* needed) {
+        double lat_span = radius / 111.195; // km per degree of latitude
+        double lon_span = radius / (111.195 * cos(lat * M_PI / 180.0));
+
+        for (int row = tile_index(lat - lat_span); row <= tile_index(lat + lat_span); row++) {
+            for (int col = tile_index(lon - lon_span); col <= tile_index(lon + lon_span); col++) {
+                // Closest point of the tile to the query centre
+                double tile_lat = fmax(row * TILE_DEGREES, fmin(lat, (row + 1) * TILE_DEGREES));
+                double tile_lon = fmax(col * TILE_DEGREES, fmin(lon, (col + 1) * TILE_DEGREES));
+                if (haversine_distance(lat, lon, tile_lat, tile_lon) <= radius) {
+                    needed[shard_for_tile(row, col, num_shards)] = 1;
+                }
+            }
+        }
+    }
+
+    int sharded_radius_query(int num_shards, const char* college, double radius, const char* specialization, int open_hour) {
+        if (num_shards < 1 || num_shards > MAX_SHARDS) {
+            printf("Number of shards must be between 1 and %d.\n", MAX_SHARDS);
+            return 1;
+        }
+
+        double lat, lon;
+        if (!find_college_coordinates(college, &lat, &lon)) {
+            printf("Invalid College Name.\n");
+            return 1;
+        }
+
+        int needed[MAX_SHARDS] = {0};
+        mark_shards_for_circle(lat, lon, radius, num_shards, needed);
+
+        struct ShardResult* results[MAX_SHARDS] = {NULL};
+        int counts[MAX_SHARDS] = {0};
+        pid_t spawned[MAX_SHARDS] = {0};
+        int queried = 0;
+
+        for (int s = 0; s < num_shards; s++) {
+            if (!needed[s]) {
+                continue;
+            }
+
+            int fd = connect_to_shard(s, num_shards);
+            if (fd < 0) {
+                // No worker is running for this shard, start a local one
+                fflush(stdout);
+                pid_t pid = fork();
+                if (pid == 0) {
+                    _exit(run_shard_worker(s, num_shards));
+                }
+                if (pid < 0) {
+                    printf("Cannot start a worker for shard %d.\n", s);
+                    continue;
+                }
+                spawned[s] = pid;
+                for (int attempt = 0; attempt < 200 && fd < 0; attempt++) {
+                    usleep(10000);
+                    fd = connect_to_shard(s, num_shards);
+                }
+                if (fd < 0) {
+                    printf("Shard %d is not reachable.\n", s);
+                    kill(pid, SIGTERM); // never sent QUIT, so stop it before waiting on it
+                    continue;
+                }
+            }
+
+            FILE* in = fdopen(fd, "r");
+            FILE* out = fdopen(dup(fd), "w");
+            fprintf(out, "QUERY;%.8lf;%.8lf;%.6lf;%s;%d\n", lat, lon, radius, specialization, open_hour);
+            fflush(out);
+
+            int capacity = 0;
+            char line[MAX_NAME_LENGTH * 2];
+            while (fgets(line, sizeof(line), in) && strncmp(line, "END", 3) != 0) {
+                if (counts[s] == capacity) {
+                    capacity = capacity == 0 ? 16 : capacity * 2;
+                    results[s] = realloc(results[s], capacity * sizeof(struct ShardResult));
+                }
+                struct ShardResult* result = &results[s][counts[s]];
+                if (sscanf(line, "%[^;];%lf", result->name, &result->distance) == 2) {
+                    counts[s]++;
+                }
+            }
+
+            if (spawned[s]) {
+                fprintf(out, "QUIT\n");
+            }
+            fclose(out);
+            fclose(in);
+            queried++;
+        }
+
+        printf("Hospitals within %.2lf km of %s with specialization '%s'\n", radius, college, specialization);
+        if (open_hour >= 0) {
+            printf("Open at %02d:00\n", open_hour % 24);
+        }
+        printf("\n");
+
+        // Merge the per-shard lists, each already sorted by distance
+        int heads[MAX_SHARDS] = {0};
+        int hospital_count = 0;
+        while (1) {
+            int best = -1;
+            for (int s = 0; s < num_shards; s++) {
+                if (heads[s] < counts[s] &&
+                    (best == -1 || results[s][heads[s]].distance < results[best][heads[best]].distance)) {
+                    best = s;
+                }
+            }
+            if (best == -1) {
+                break;
+            }
+            printf("%s  ==>  Distance: %.2lf km\n", results[best][heads[best]].name, results[best][heads[best]].distance);
+            heads[best]++;
+            hospital_count++;
+        }
+
+        if (hospital_count == 0) {
+            printf("No hospitals found within %.2lf km with specialization '%s'.\n", radius, specialization);
+        }
+        printf("\n(%d of %d shards queried)\n", queried, num_shards);
+
+        for (int s = 0; s < num_shards; s++) {
+            free(results[s]);
+            if (spawned[s]) {
+                waitpid(spawned[s], NULL, 0);
+            }
+        }
+        return 0;
+    }
+
+    // Session record/replay. A recorded session is "<session>" holding one
+    // "<ms since start> <input line>" entry per line typed, "<session>.out" with
+    // everything the program printed, and "<session>.data/" with a snapshot of
+    // the data files, so a replay starts from exactly the recorded state.
+    const char* data_files[] = {"colleges.txt", "hospitals.txt", "info.txt", "reviews.txt", "comments.txt", "outputFile.txt",
+                                "roads.txt", "roads.ch", "comments.idx"};
+
+    pid_t recorder_pid = 0;
+    pid_t tee_pid = 0;
+
+    long long now_us() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    int copy_file(const char* from, const char* to) {
+        FILE* in = fopen(from, "rb");
+        if (in == NULL) {
+            return 0;
+        }
+        FILE* out = fopen(to, "wb");
+        if (out == NULL) {
+            fclose(in);
+            return 0;
+        }
+
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            fwrite(buffer, 1, n, out);
+        }
+
+        fclose(in);
+        fclose(out);
+        return 1;
+    }
+
+    // Copies the data files from one directory to another, skipping missing ones
+    void copy_data_files(const char* from_dir, const char* to_dir) {
+        for (int i = 0; i < (int)(sizeof(data_files) / sizeof(data_files[0])); i++) {
+            char from[PATH_MAX], to[PATH_MAX];
+            snprintf(from, sizeof(from), "%s/%s", from_dir, data_files[i]);
+            snprintf(to, sizeof(to), "%s/%s", to_dir, data_files[i]);
+            copy_file(from, to);
+        }
+    }
+
+    void remove_directory(const char* dir) {
+        DIR* d = opendir(dir);
+        if (d == NULL) {
+            return;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(d)) != NULL) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                char path[PATH_MAX];
+                snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+                unlink(path);
+            }
+        }
+        closedir(d);
+        rmdir(dir);
+    }
+
+    void stop_session_recording() {
+        // Closing stdout gives the tee process EOF; the input recorder may be
+        // blocked on the terminal, so it is stopped outright
+        fflush(stdout);
+        close(STDOUT_FILENO);
+        if (recorder_pid > 0) {
+            kill(recorder_pid, SIGTERM);
+            waitpid(recorder_pid, NULL, 0);
+        }
+        if (tee_pid > 0) {
+            waitpid(tee_pid, NULL, 0);
+        }
+    }
+
+    // Interposes two helper processes: one timestamps every input line into the
+    // session file before passing it on, the other copies all output to the
+    // terminal and to "<session>.out". The program itself runs unchanged.
+    int start_session_recording(const char* session_file) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.data", session_file);
+        mkdir(path, 0755);
+        copy_data_files(".", path);
+
+        FILE* log = fopen(session_file, "w");
+        snprintf(path, sizeof(path), "%s.out", session_file);
+        FILE* out = fopen(path, "wb");
+        if (log == NULL || out == NULL) {
+            printf("Error opening session files for writing.\n");
+            return 0;
+        }
+
+        int in_pipe[2], out_pipe[2];
+        if (pipe(in_pipe) < 0) {
+            return 0;
+        }
+        long long start = now_us();
+        recorder_pid = fork();
+        if (recorder_pid == 0) {
+            close(in_pipe[0]);
+            char line[MAX_NAME_LENGTH * 4];
+            while (fgets(line, sizeof(line), stdin)) {
+                fprintf(log, "%lld %s", (now_us() - start) / 1000, line);
+                fflush(log);
+                if (write(in_pipe[1], line, strlen(line)) < 0) {
+                    break;
+                }
+            }
+            _exit(0);
+        }
+        fclose(log);
+        dup2(in_pipe[0], STDIN_FILENO);
+        close(in_pipe[0]);
+        close(in_pipe[1]);
+
+        if (pipe(out_pipe) < 0) {
+            return 0;
+        }
+        tee_pid = fork();
+        if (tee_pid == 0) {
+            close(out_pipe[1]);
+            char buffer[4096];
+            ssize_t n;
+            while ((n = read(out_pipe[0], buffer, sizeof(buffer))) > 0) {
+                if (write(STDOUT_FILENO, buffer, n) < 0) {
+                    break;
+                }
+                fwrite(buffer, 1, n, out);
+            }
+            fclose(out);
+            _exit(0);
+        }
+        fclose(out);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+
+        // Prompts do not end in a newline, so line buffering is not enough
+        setvbuf(stdout, NULL, _IONBF, 0);
+        atexit(stop_session_recording);
+        return 1;
+    }
+
+    struct SessionInput {
+        long long at_ms;
+        char* line;
+    };
+
+    struct ReplaySession {
+        const char* session_file;
+        struct SessionInput* inputs;
+        int num_inputs;
+        char* expected; // NULL when there is no "<session>.out"
+        size_t expected_size;
+    };
+
+    struct RunningReplay {
+        struct ReplaySession* session;
+        pid_t pid;
+        int stdin_fd;  // -1 once all input is written
+        int stdout_fd;
+        int next_input;
+        size_t input_offset; // bytes of the next input already written
+        int stdout_poll;     // index into the poll set
+        int stdin_poll;      // index into the poll set, -1 when no input is due
+        long long start_us;
+        char dir[64];
+        char* output;
+        size_t output_size;
+        size_t output_capacity;
+    };
+
+    char* read_whole_file(const char* filename, size_t* size) {
+        FILE* file = fopen(filename, "rb");
+        if (file == NULL) {
+            return NULL;
+        }
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        char* data = malloc(length + 1);
+        *size = fread(data, 1, length, file);
+        data[*size] = '\0';
+        fclose(file);
+        return data;
+    }
+
+    int load_replay_session(const char* session_file, struct ReplaySession* session) {
+        FILE* file = fopen(session_file, "r");
+        if (file == NULL) {
+            printf("Error opening session %s.\n", session_file);
+            return 0;
+        }
+
+        session->session_file = session_file;
+        session->inputs = NULL;
+        session->num_inputs = 0;
+        int capacity = 0;
+        char line[MAX_NAME_LENGTH * 4];
+        while (fgets(line, sizeof(line), file)) {
+            char* text;
+            long long at_ms = strtoll(line, &text, 10);
+            if (text == line || *text != ' ') {
+                continue;
+            }
+            if (session->num_inputs == capacity) {
+                capacity = capacity == 0 ? 8 : capacity * 2;
+                session->inputs = realloc(session->inputs, capacity * sizeof(struct SessionInput));
+            }
+            session->inputs[session->num_inputs].at_ms = at_ms;
+            session->inputs[session->num_inputs].line = strdup(text + 1);
+            session->num_inputs++;
+        }
+        fclose(file);
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.out", session_file);
+        session->expected = read_whole_file(path, &session->expected_size);
+        return 1;
+    }
+
+    int start_replay(struct ReplaySession* session, struct RunningReplay* run) {
+        strcpy(run->dir, "/tmp/hospital_replay_XXXXXX");
+        if (mkdtemp(run->dir) == NULL) {
+            printf("Error creating replay directory.\n");
+            return 0;
+        }
+        char data_dir[PATH_MAX];
+        snprintf(data_dir, sizeof(data_dir), "%s.data", session->session_file);
+        copy_data_files(access(data_dir, F_OK) == 0 ? data_dir : ".", run->dir);
+
+        int in_pipe[2], out_pipe[2];
+        if (pipe(in_pipe) < 0) {
+            printf("Error creating replay pipes: %s\n", strerror(errno));
+            remove_directory(run->dir);
+            return 0;
+        }
+        if (pipe(out_pipe) < 0) {
+            printf("Error creating replay pipes: %s\n", strerror(errno));
+            close(in_pipe[0]);
+            close(in_pipe[1]);
+            remove_directory(run->dir);
+            return 0;
+        }
+        // Keep the parent's ends out of every other replayed process, or they
+        // would never see EOF on stdin
+        fcntl(in_pipe[1], F_SETFD, FD_CLOEXEC);
+        fcntl(out_pipe[0], F_SETFD, FD_CLOEXEC);
+
+        fflush(stdout);
+        run->pid = fork();
+        if (run->pid == 0) {
+            dup2(in_pipe[0], STDIN_FILENO);
+            dup2(out_pipe[1], STDOUT_FILENO);
+            close(in_pipe[0]);
+            close(out_pipe[1]);
+            if (chdir(run->dir) == 0) {
+                execl("/proc/self/exe", "project", (char*)NULL);
+            }
+            _exit(127);
+        }
+        close(in_pipe[0]);
+        close(out_pipe[1]);
+        if (run->pid < 0) {
+            printf("Error starting replay process: %s\n", strerror(errno));
+            close(in_pipe[1]);
+            close(out_pipe[0]);
+            remove_directory(run->dir);
+            return 0;
+        }
+        fcntl(in_pipe[1], F_SETFL, O_NONBLOCK);
+
+        run->session = session;
+        run->stdin_fd = in_pipe[1];
+        run->stdout_fd = out_pipe[0];
+        run->next_input = 0;
+        run->input_offset = 0;
+        run->start_us = now_us();
+        run->output = NULL;
+        run->output_size = 0;
+        run->output_capacity = 0;
+        return 1;
+    }
+
+    // Returns 1 if the output matched (or there was nothing to compare against)
+    int finish_replay(struct RunningReplay* run) {
+        waitpid(run->pid, NULL, 0);
+        if (run->stdin_fd >= 0) {
+            close(run->stdin_fd);
+        }
+        close(run->stdout_fd);
+        remove_directory(run->dir);
+
+        struct ReplaySession* session = run->session;
+        int matched = session->expected == NULL ||
+                      (run->output_size == session->expected_size &&
+                       memcmp(run->output, session->expected, run->output_size) == 0);
+        if (!matched) {
+            size_t line = 1;
+            for (size_t i = 0; i < run->output_size && i < session->expected_size && run->output[i] == session->expected[i]; i++) {
+                line += run->output[i] == '\n';
+            }
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s.actual", session->session_file);
+            FILE* file = fopen(path, "wb");
+            if (file != NULL) {
+                fwrite(run->output, 1, run->output_size, file);
+                fclose(file);
+            }
+            printf("MISMATCH %s: output differs from line %zu, see %s\n", session->session_file, line, path);
+        }
+        free(run->output);
+        return matched;
+    }
+
+    int compare_latencies(const void* a, const void* b) {
+        long long la = *(const long long*)a;
+        long long lb = *(const long long*)b;
+        return (la > lb) - (la < lb);
+    }
+
+    // Replays every session file with up to `concurrency` processes at once.
+    // Recorded think time between inputs is scaled by `pace`; 0 sends input as
+    // fast as the program reads it.
+    int replay_sessions(int concurrency, double pace, int num_files, char* files[]) {
+        if (concurrency < 1 || num_files < 1) {
+            printf("Usage: --replay <concurrency> <pace> <session>...\n");
+            return 1;
+        }
+        signal(SIGPIPE, SIG_IGN);
+
+        // Each running replay holds two pipe ends, plus a few transient
+        // descriptors while its data files are copied
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+            if (limit.rlim_cur < limit.rlim_max) {
+                limit.rlim_cur = limit.rlim_max;
+                setrlimit(RLIMIT_NOFILE, &limit);
+                getrlimit(RLIMIT_NOFILE, &limit);
+            }
+            if (limit.rlim_cur != RLIM_INFINITY && (rlim_t)concurrency * 2 + 16 > limit.rlim_cur) {
+                int capped = limit.rlim_cur > 18 ? (int)((limit.rlim_cur - 16) / 2) : 1;
+                printf("Concurrency limited to %d by the open file limit (%llu).\n", capped, (unsigned long long)limit.rlim_cur);
+                concurrency = capped;
+            }
+        }
+
+        struct ReplaySession* sessions = malloc(num_files * sizeof(struct ReplaySession));
+        for (int i = 0; i < num_files; i++) {
+            if (!load_replay_session(files[i], &sessions[i])) {
+                return 1;
+            }
+        }
+
+        struct RunningReplay* running = malloc(concurrency * sizeof(struct RunningReplay));
+        struct pollfd* fds = malloc(concurrency * 2 * sizeof(struct pollfd));
+        long long* latencies = malloc(num_files * sizeof(long long));
+        int num_running = 0;
+        int next_session = 0;
+        int completed = 0;
+        int mismatches = 0;
+        long long started = now_us();
+
+        while (completed < num_files) {
+            while (num_running < concurrency && next_session < num_files) {
+                if (!start_replay(&sessions[next_session], &running[num_running])) {
+                    if (num_running == 0) {
+                        break; // Nothing running that could free resources
+                    }
+                    // Out of processes or descriptors: carry on with the
+                    // replays already running and retry as they finish
+                    concurrency = num_running;
+                    printf("Concurrency reduced to %d.\n", concurrency);
+                    break;
+                }
+                num_running++;
+                next_session++;
+            }
+            if (num_running == 0) {
+                printf("Replay stopped after %d of %d sessions.\n", completed, num_files);
+                break;
+            }
+
+            // Watch every output pipe, and the input pipes whose next line is due
+            int num_fds = 0;
+            int timeout_ms = -1;
+            long long now = now_us();
+            for (int r = 0; r < num_running; r++) {
+                struct RunningReplay* run = &running[r];
+                run->stdout_poll = num_fds;
+                run->stdin_poll = -1;
+                fds[num_fds].fd = run->stdout_fd;
+                fds[num_fds].events = POLLIN;
+                num_fds++;
+
+                if (run->stdin_fd < 0) {
+                    continue;
+                }
+                if (run->next_input == run->session->num_inputs) {
+                    close(run->stdin_fd);
+                    run->stdin_fd = -1;
+                    continue;
+                }
+                long long due_us = run->start_us + (long long)(run->session->inputs[run->next_input].at_ms * 1000 * pace);
+                if (due_us <= now) {
+                    run->stdin_poll = num_fds;
+                    fds[num_fds].fd = run->stdin_fd;
+                    fds[num_fds].events = POLLOUT;
+                    num_fds++;
+                } else {
+                    int wait_ms = (int)((due_us - now) / 1000) + 1;
+                    if (timeout_ms < 0 || wait_ms < timeout_ms) {
+                        timeout_ms = wait_ms;
+                    }
+                }
+            }
+
+            if (poll(fds, num_fds, timeout_ms) < 0) {
+                continue;
+            }
+
+            for (int r = 0; r < num_running; r++) {
+                struct RunningReplay* run = &running[r];
+
+                if (run->stdin_poll >= 0 && (fds[run->stdin_poll].revents & (POLLOUT | POLLERR))) {
+                    const char* line = run->session->inputs[run->next_input].line;
+                    size_t length = strlen(line);
+                    ssize_t n = write(run->stdin_fd, line + run->input_offset, length - run->input_offset);
+                    if (n > 0) {
+                        run->input_offset += n;
+                        if (run->input_offset == length) {
+                            run->next_input++;
+                            run->input_offset = 0;
+                        }
+                    } else if (n < 0 && errno != EAGAIN) {
+                        // The program exited before reading all input
+                        close(run->stdin_fd);
+                        run->stdin_fd = -1;
+                    }
+                }
+
+                if (!(fds[run->stdout_poll].revents & (POLLIN | POLLHUP | POLLERR))) {
+                    continue;
+                }
+                if (run->output_capacity - run->output_size < 4096) {
+                    run->output_capacity = run->output_capacity * 2 + 4096;
+                    run->output = realloc(run->output, run->output_capacity);
+                }
+                ssize_t n = read(run->stdout_fd, run->output + run->output_size, run->output_capacity - run->output_size);
+                if (n > 0) {
+                    run->output_size += n;
+                } else if (n == 0) {
+                    latencies[completed++] = now_us() - run->start_us;
+                    mismatches += !finish_replay(run);
+                    running[r] = running[--num_running];
+                    r--;
+                }
+            }
+        }
+        long long elapsed = now_us() - started;
+
+        if (completed > 0) {
+            qsort(latencies, completed, sizeof(long long), compare_latencies);
+            printf("\nReplayed %d sessions with concurrency %d in %.1f ms (%.1f sessions/s)\n",
+                   completed, concurrency, elapsed / 1000.0, completed / (elapsed / 1e6));
+            printf("Session latency (ms): min %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+                   latencies[0] / 1000.0, latencies[completed / 2] / 1000.0,
+                   latencies[(int)(completed * 0.95)] / 1000.0, latencies[(int)(completed * 0.99)] / 1000.0,
+                   latencies[completed - 1] / 1000.0);
+            printf("Output mismatches: %d\n", mismatches);
+        }
+
+        for (int i = 0; i < num_files; i++) {
+            for (int j = 0; j < sessions[i].num_inputs; j++) {
+                free(sessions[i].inputs[j].line);
+            }
+            free(sessions[i].inputs);
+            free(sessions[i].expected);
+        }
+        free(sessions);
+        free(running);
+        free(fds);
+        free(latencies);
+        return mismatches > 0 || completed < num_files;
+    }
 
-                // Display the comment from the file (without "(from file)")
-                printf("User: %s\n", user_name);
-                printf("Comment: %s\n\n", text);
-                found_comments = 1;
+    // Road routing with a contraction hierarchy over the optional roads.txt:
+    //   NODE;<id>;<latitude>;<longitude>   ids numbered 0, 1, 2, ... in order
+    //   EDGE;<from id>;<to id>;<minutes>   roads are two-way
+    // Nodes are contracted one by one, adding shortcut edges that preserve
+    // travel times, so a query only walks "upward" from both ends and meets in
+    // the middle. The hierarchy is cached in roads.ch.
+    struct RoadEdge {
+        int to;
+        double minutes;
+        int middle; // node a shortcut bypasses, -1 for an actual road
+    };
+
+    struct RoadEdgeList {
+        struct RoadEdge* edges;
+        int count;
+        int capacity;
+    };
+
+    struct MinHeap {
+        double* keys;
+        int* nodes;
+        int size;
+        int capacity;
+    };
+
+    struct ContractionHierarchy {
+        int num_nodes;
+        int num_edges;
+        double* latitude;
+        double* longitude;
+        int* first_edge; // upward edges of v are edges[first_edge[v] .. first_edge[v + 1])
+        struct RoadEdge* edges;
+        // Query workspace, reset after every query
+        double* dist[2];
+        int* parent[2];
+        int* parent_edge[2];
+        int* touched;
+        int num_touched;
+        struct MinHeap heap[2];
+        // Uniform grid over the node coordinates for snapping points to the network
+        double grid_lat;  // south-west corner
+        double grid_lon;
+        double grid_cell; // cell size in degrees
+        int grid_rows;
+        int grid_cols;
+        int* cell_start;  // nodes of cell c are cell_nodes[cell_start[c] .. cell_start[c + 1])
+        int* cell_nodes;
+    };
+
+    struct Route {
+        int* nodes;
+        int count;
+        int capacity;
+    };
+
+    void heap_push(struct MinHeap* heap, double key, int node) {
+        if (heap->size == heap->capacity) {
+            heap->capacity = heap->capacity == 0 ? 64 : heap->capacity * 2;
+            heap->keys = realloc(heap->keys, heap->capacity * sizeof(double));
+            heap->nodes = realloc(heap->nodes, heap->capacity * sizeof(int));
+        }
+        int i = heap->size++;
+        while (i > 0 && heap->keys[(i - 1) / 2] > key) {
+            heap->keys[i] = heap->keys[(i - 1) / 2];
+            heap->nodes[i] = heap->nodes[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap->keys[i] = key;
+        heap->nodes[i] = node;
+    }
+
+    int heap_pop(struct MinHeap* heap, double* key) {
+        int node = heap->nodes[0];
+        *key = heap->keys[0];
+        double last_key = heap->keys[--heap->size];
+        int last_node = heap->nodes[heap->size];
+        int i = 0;
+        while (2 * i + 1 < heap->size) {
+            int child = 2 * i + 1;
+            if (child + 1 < heap->size && heap->keys[child + 1] < heap->keys[child]) {
+                child++;
+            }
+            if (heap->keys[child] >= last_key) {
+                break;
             }
+            heap->keys[i] = heap->keys[child];
+            heap->nodes[i] = heap->nodes[child];
+            i = child;
         }
+        heap->keys[i] = last_key;
+        heap->nodes[i] = last_node;
+        return node;
     }
 
-    fclose(file);
+    // Adds the two-way edge u-w, or lowers its time if it already exists
+    void add_road_edge(struct RoadEdgeList* adjacency, int u, int w, double minutes, int middle) {
+        for (int side = 0; side < 2; side++) {
+            int from = side == 0 ? u : w;
+            int to = side == 0 ? w : u;
+            struct RoadEdgeList* list = &adjacency[from];
+            int i = 0;
+            while (i < list->count && list->edges[i].to != to) {
+                i++;
+            }
+            if (i == list->count) {
+                if (list->count == list->capacity) {
+                    list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+                    list->edges = realloc(list->edges, list->capacity * sizeof(struct RoadEdge));
+                }
+                list->count++;
+            } else if (list->edges[i].minutes <= minutes) {
+                continue;
+            }
+            list->edges[i].to = to;
+            list->edges[i].minutes = minutes;
+            list->edges[i].middle = middle;
+        }
+    }
 
-    if (!found_comments) {
-        // printf("No additional comments available from the file.\n");
+    // Shortest time from source to any node without passing through `skip` or
+    // an already contracted node, giving up beyond max_minutes or settle_limit
+    // settled nodes. Results are left in dist[], touched nodes in touched[].
+    void witness_search(struct RoadEdgeList* adjacency, bool* contracted, int source, int skip, double max_minutes,
+                        double* dist, int* touched, int* num_touched, struct MinHeap* heap) {
+        const int settle_limit = 500;
+        heap->size = 0;
+        dist[source] = 0;
+        touched[(*num_touched)++] = source;
+        heap_push(heap, 0, source);
+
+        int settled = 0;
+        while (heap->size > 0 && settled < settle_limit) {
+            double d;
+            int u = heap_pop(heap, &d);
+            if (d > dist[u]) {
+                continue;
+            }
+            if (d > max_minutes) {
+                break;
+            }
+            settled++;
+            for (int i = 0; i < adjacency[u].count; i++) {
+                struct RoadEdge* edge = &adjacency[u].edges[i];
+                if (edge->to == skip || contracted[edge->to]) {
+                    continue;
+                }
+                double nd = d + edge->minutes;
+                if (nd < dist[edge->to]) {
+                    if (dist[edge->to] == INFINITY) {
+                        touched[(*num_touched)++] = edge->to;
+                    }
+                    dist[edge->to] = nd;
+                    heap_push(heap, nd, edge->to);
+                }
+            }
+        }
     }
-}
 
+    // Counts (and with add_shortcuts, inserts) the shortcuts needed to contract v
+    int contract_node(struct RoadEdgeList* adjacency, bool* contracted, int v, bool add_shortcuts,
+                      double* dist, int* touched, struct MinHeap* heap) {
+        struct RoadEdgeList* list = &adjacency[v];
+        double max_out = 0;
+        for (int i = 0; i < list->count; i++) {
+            if (!contracted[list->edges[i].to] && list->edges[i].minutes > max_out) {
+                max_out = list->edges[i].minutes;
+            }
+        }
 
-    void save_comments_to_file(struct Comment* comments, int num_comments, const char* filename) {
-        FILE* file = fopen(filename, "w");
+        // Shortcuts are collected first because adding them reallocates list->edges
+        int shortcuts = 0;
+        int capacity = 0;
+        struct RoadEdge* pending = NULL;
+        int* pending_from = NULL;
+        for (int i = 0; i < list->count; i++) {
+            struct RoadEdge in = list->edges[i];
+            if (contracted[in.to]) {
+                continue;
+            }
+            int num_touched = 0;
+            witness_search(adjacency, contracted, in.to, v, in.minutes + max_out, dist, touched, &num_touched, heap);
+            for (int j = i + 1; j < list->count; j++) {
+                struct RoadEdge out = list->edges[j];
+                if (contracted[out.to]) {
+                    continue;
+                }
+                double via = in.minutes + out.minutes;
+                if (dist[out.to] > via) {
+                    if (add_shortcuts) {
+                        if (shortcuts == capacity) {
+                            capacity = capacity == 0 ? 8 : capacity * 2;
+                            pending = realloc(pending, capacity * sizeof(struct RoadEdge));
+                            pending_from = realloc(pending_from, capacity * sizeof(int));
+                        }
+                        pending[shortcuts].to = out.to;
+                        pending[shortcuts].minutes = via;
+                        pending[shortcuts].middle = v;
+                        pending_from[shortcuts] = in.to;
+                    }
+                    shortcuts++;
+                }
+            }
+            for (int t = 0; t < num_touched; t++) {
+                dist[touched[t]] = INFINITY;
+            }
+        }
+
+        if (add_shortcuts) {
+            for (int s = 0; s < shortcuts; s++) {
+                add_road_edge(adjacency, pending_from[s], pending[s].to, pending[s].minutes, pending[s].middle);
+            }
+        }
+        free(pending);
+        free(pending_from);
+        return shortcuts;
+    }
+
+    int node_priority(struct RoadEdgeList* adjacency, bool* contracted, int* contracted_neighbors, int v,
+                      double* dist, int* touched, struct MinHeap* heap) {
+        int degree = 0;
+        for (int i = 0; i < adjacency[v].count; i++) {
+            degree += !contracted[adjacency[v].edges[i].to];
+        }
+        int shortcuts = contract_node(adjacency, contracted, v, false, dist, touched, heap);
+        return shortcuts - degree + contracted_neighbors[v];
+    }
+
+    void allocate_query_workspace(struct ContractionHierarchy* ch) {
+        for (int dir = 0; dir < 2; dir++) {
+            ch->dist[dir] = malloc(ch->num_nodes * sizeof(double));
+            ch->parent[dir] = malloc(ch->num_nodes * sizeof(int));
+            ch->parent_edge[dir] = malloc(ch->num_nodes * sizeof(int));
+            for (int v = 0; v < ch->num_nodes; v++) {
+                ch->dist[dir][v] = INFINITY;
+            }
+            ch->heap[dir].keys = NULL;
+            ch->heap[dir].nodes = NULL;
+            ch->heap[dir].size = 0;
+            ch->heap[dir].capacity = 0;
+        }
+        ch->touched = malloc(2 * ch->num_nodes * sizeof(int));
+        ch->num_touched = 0;
+    }
+
+    int grid_cell_index(struct ContractionHierarchy* ch, int row, int col) {
+        return row * ch->grid_cols + col;
+    }
+
+    int grid_coordinate(double degrees, double origin, double cell, int cells) {
+        int index = (int)floor((degrees - origin) / cell);
+        return index < 0 ? 0 : index >= cells ? cells - 1 : index;
+    }
+
+    // Buckets the nodes into square cells holding about two nodes each
+    void build_road_grid(struct ContractionHierarchy* ch) {
+        double min_lat = DBL_MAX, max_lat = -DBL_MAX, min_lon = DBL_MAX, max_lon = -DBL_MAX;
+        for (int v = 0; v < ch->num_nodes; v++) {
+            min_lat = fmin(min_lat, ch->latitude[v]);
+            max_lat = fmax(max_lat, ch->latitude[v]);
+            min_lon = fmin(min_lon, ch->longitude[v]);
+            max_lon = fmax(max_lon, ch->longitude[v]);
+        }
+        double lat_span = fmax(max_lat - min_lat, 1e-6);
+        double lon_span = fmax(max_lon - min_lon, 1e-6);
+        double cell = sqrt(lat_span * lon_span / (ch->num_nodes / 2.0 + 1));
+        // A long, thin network would otherwise get far more cells than nodes
+        cell = fmax(cell, fmax(lat_span, lon_span) / (ch->num_nodes + 1));
+
+        ch->grid_lat = min_lat;
+        ch->grid_lon = min_lon;
+        ch->grid_cell = cell;
+        ch->grid_rows = (int)(lat_span / cell) + 1;
+        ch->grid_cols = (int)(lon_span / cell) + 1;
+        int num_cells = ch->grid_rows * ch->grid_cols;
+
+        ch->cell_start = calloc(num_cells + 1, sizeof(int));
+        ch->cell_nodes = malloc(ch->num_nodes * sizeof(int));
+        int* node_cell = malloc(ch->num_nodes * sizeof(int));
+        for (int v = 0; v < ch->num_nodes; v++) {
+            node_cell[v] = grid_cell_index(ch, grid_coordinate(ch->latitude[v], min_lat, cell, ch->grid_rows),
+                                           grid_coordinate(ch->longitude[v], min_lon, cell, ch->grid_cols));
+            ch->cell_start[node_cell[v] + 1]++;
+        }
+        for (int c = 0; c < num_cells; c++) {
+            ch->cell_start[c + 1] += ch->cell_start[c];
+        }
+        int* fill = malloc(num_cells * sizeof(int));
+        memcpy(fill, ch->cell_start, num_cells * sizeof(int));
+        for (int v = 0; v < ch->num_nodes; v++) {
+            ch->cell_nodes[fill[node_cell[v]]++] = v;
+        }
+        free(fill);
+        free(node_cell);
+    }
+
+    int build_contraction_hierarchy(const char* filename, struct ContractionHierarchy* ch) {
+        FILE* file = fopen(filename, "r");
         if (file == NULL) {
-            printf("Error opening file for writing comments.\n");
-            return;
+            return 0;
+        }
+
+        int num_nodes = 0;
+        int node_capacity = 0;
+        double* latitude = NULL;
+        double* longitude = NULL;
+        struct RoadEdgeList* adjacency = NULL;
+        char line[MAX_NAME_LENGTH];
+        while (fgets(line, sizeof(line), file)) {
+            int id, from, to;
+            double lat, lon, minutes;
+            if (sscanf(line, "NODE;%d;%lf;%lf", &id, &lat, &lon) == 3) {
+                if (id != num_nodes) {
+                    printf("Road node ids must be numbered in order (got %d, expected %d).\n", id, num_nodes);
+                    fclose(file);
+                    return 0;
+                }
+                if (num_nodes == node_capacity) {
+                    node_capacity = node_capacity == 0 ? 1024 : node_capacity * 2;
+                    latitude = realloc(latitude, node_capacity * sizeof(double));
+                    longitude = realloc(longitude, node_capacity * sizeof(double));
+                    adjacency = realloc(adjacency, node_capacity * sizeof(struct RoadEdgeList));
+                }
+                latitude[num_nodes] = lat;
+                longitude[num_nodes] = lon;
+                adjacency[num_nodes].edges = NULL;
+                adjacency[num_nodes].count = 0;
+                adjacency[num_nodes].capacity = 0;
+                num_nodes++;
+            } else if (sscanf(line, "EDGE;%d;%d;%lf", &from, &to, &minutes) == 3) {
+                if (from < 0 || from >= num_nodes || to < 0 || to >= num_nodes || from == to) {
+                    continue;
+                }
+                add_road_edge(adjacency, from, to, minutes, -1);
+            }
+        }
+        fclose(file);
+        if (num_nodes == 0) {
+            return 0;
+        }
+
+        bool* contracted = calloc(num_nodes, sizeof(bool));
+        int* contracted_neighbors = calloc(num_nodes, sizeof(int));
+        int* rank = malloc(num_nodes * sizeof(int));
+        double* dist = malloc(num_nodes * sizeof(double));
+        int* touched = malloc(num_nodes * sizeof(int));
+        struct MinHeap witness_heap = {NULL, NULL, 0, 0};
+        struct MinHeap order = {NULL, NULL, 0, 0};
+        for (int v = 0; v < num_nodes; v++) {
+            dist[v] = INFINITY;
+        }
+        for (int v = 0; v < num_nodes; v++) {
+            heap_push(&order, node_priority(adjacency, contracted, contracted_neighbors, v, dist, touched, &witness_heap), v);
+        }
+
+        // Lazy updates: a node's priority is recomputed when it reaches the top
+        // and it is only contracted if it is still no worse than the next one
+        int next_rank = 0;
+        while (order.size > 0) {
+            double priority;
+            int v = heap_pop(&order, &priority);
+            int current = node_priority(adjacency, contracted, contracted_neighbors, v, dist, touched, &witness_heap);
+            if (order.size > 0 && current > order.keys[0]) {
+                heap_push(&order, current, v);
+                continue;
+            }
+
+            contract_node(adjacency, contracted, v, true, dist, touched, &witness_heap);
+            contracted[v] = true;
+            rank[v] = next_rank++;
+            for (int i = 0; i < adjacency[v].count; i++) {
+                contracted_neighbors[adjacency[v].edges[i].to]++;
+            }
         }
 
-        for (int i = 0; i < num_comments; i++) {
-            fprintf(file, "%s;%s;%s\n", comments[i].hospital_name, comments[i].user_name, comments[i].text);
+        // Keep only the edges leading to higher ranked nodes
+        ch->num_nodes = num_nodes;
+        ch->latitude = latitude;
+        ch->longitude = longitude;
+        ch->first_edge = malloc((num_nodes + 1) * sizeof(int));
+        ch->num_edges = 0;
+        for (int v = 0; v < num_nodes; v++) {
+            for (int i = 0; i < adjacency[v].count; i++) {
+                ch->num_edges += rank[adjacency[v].edges[i].to] > rank[v];
+            }
+        }
+        ch->edges = malloc((ch->num_edges > 0 ? ch->num_edges : 1) * sizeof(struct RoadEdge));
+        int e = 0;
+        for (int v = 0; v < num_nodes; v++) {
+            ch->first_edge[v] = e;
+            for (int i = 0; i < adjacency[v].count; i++) {
+                if (rank[adjacency[v].edges[i].to] > rank[v]) {
+                    ch->edges[e++] = adjacency[v].edges[i];
+                }
+            }
+            free(adjacency[v].edges);
         }
+        ch->first_edge[num_nodes] = e;
+
+        free(adjacency);
+        free(contracted);
+        free(contracted_neighbors);
+        free(rank);
+        free(dist);
+        free(touched);
+        free(witness_heap.keys);
+        free(witness_heap.nodes);
+        free(order.keys);
+        free(order.nodes);
+        allocate_query_workspace(ch);
+        build_road_grid(ch);
+        return 1;
+    }
+
+    const unsigned int HIERARCHY_MAGIC = 0x31484348; // "HCH1"
 
+    int save_contraction_hierarchy(struct ContractionHierarchy* ch, const char* filename) {
+        FILE* file = fopen(filename, "wb");
+        if (file == NULL) {
+            printf("Error opening file for writing.\n");
+            return 0;
+        }
+        fwrite(&HIERARCHY_MAGIC, sizeof(HIERARCHY_MAGIC), 1, file);
+        fwrite(&ch->num_nodes, sizeof(int), 1, file);
+        fwrite(&ch->num_edges, sizeof(int), 1, file);
+        fwrite(ch->latitude, sizeof(double), ch->num_nodes, file);
+        fwrite(ch->longitude, sizeof(double), ch->num_nodes, file);
+        fwrite(ch->first_edge, sizeof(int), ch->num_nodes + 1, file);
+        fwrite(ch->edges, sizeof(struct RoadEdge), ch->num_edges, file);
         fclose(file);
+        return 1;
     }
 
-void display_hospitals(struct Graph* graph) {
-    printf("\nHospitals Available:\n");
-    int hospital_count = 0;
-    for (int i = 0; i < graph->num_vertices; i++) {
-        int specializationExists = 0;
-        char* L[] = {"GENERAL", "MULTISPECIALITY", "ORTHOPEDIC", "SKIN_AND_HAIR", "PEDIATRICS", "OPHTHALMOLOGY", "DENTAL", "AYURVED", "ENDOSCOPY", "ALLOPATHY","OPTHALMOLOGY"};
-        for (int j = 0; j < sizeof(L) / sizeof(L[0]); j++) {
-            if (strcmp(graph->locations[i].specialization, L[j]) == 0) {
-                specializationExists = 1;
-                break;
-            }
+    int load_contraction_hierarchy(const char* filename, struct ContractionHierarchy* ch) {
+        FILE* file = fopen(filename, "rb");
+        if (file == NULL) {
+            return 0;
         }
-        if (specializationExists) {
-            printf("%d. %s\n", hospital_count + 1, graph->locations[i].name);
-            hospital_count += 1;
+        unsigned int magic = 0;
+        if (fread(&magic, sizeof(magic), 1, file) != 1 || magic != HIERARCHY_MAGIC ||
+            fread(&ch->num_nodes, sizeof(int), 1, file) != 1 || fread(&ch->num_edges, sizeof(int), 1, file) != 1 ||
+            ch->num_nodes <= 0 || ch->num_edges < 0) {
+            fclose(file);
+            return 0;
+        }
+        ch->latitude = malloc(ch->num_nodes * sizeof(double));
+        ch->longitude = malloc(ch->num_nodes * sizeof(double));
+        ch->first_edge = malloc((ch->num_nodes + 1) * sizeof(int));
+        ch->edges = malloc((ch->num_edges > 0 ? ch->num_edges : 1) * sizeof(struct RoadEdge));
+        int ok = fread(ch->latitude, sizeof(double), ch->num_nodes, file) == (size_t)ch->num_nodes &&
+                 fread(ch->longitude, sizeof(double), ch->num_nodes, file) == (size_t)ch->num_nodes &&
+                 fread(ch->first_edge, sizeof(int), ch->num_nodes + 1, file) == (size_t)ch->num_nodes + 1 &&
+                 fread(ch->edges, sizeof(struct RoadEdge), ch->num_edges, file) == (size_t)ch->num_edges;
+        fclose(file);
+        if (!ok) {
+            free(ch->latitude);
+            free(ch->longitude);
+            free(ch->first_edge);
+            free(ch->edges);
+            return 0;
         }
+        allocate_query_workspace(ch);
+        build_road_grid(ch);
+        return 1;
     }
-}
 
-int get_hospital_index(struct Graph* graph, const char* hospital_name) {
-    // Define the list of valid specializations
-    const char* valid_specializations[] = {
-        "GENERAL",
-        "MULTISPECIALITY",
-        "ORTHOPEDIC",
-        "SKIN_AND_HAIR",
-        "PEDIATRICS",
-        "OPHTHALMOLOGY",
-        "DENTAL",
-        "AYURVED",
-        "ENDOSCOPY",
-        "ALLOPATHY",
-        "OPTHALMOLOGY"
-    };
+    // Uses roads.ch when it is newer than roads.txt, otherwise rebuilds and saves it
+    int open_road_network(struct ContractionHierarchy* ch) {
+        struct stat roads, hierarchy;
+        bool have_roads = stat(ROADS_FILE, &roads) == 0;
+        bool have_hierarchy = stat(HIERARCHY_FILE, &hierarchy) == 0;
 
-    int num_specializations = sizeof(valid_specializations) / sizeof(valid_specializations[0]);
+        if (have_hierarchy && (!have_roads || hierarchy.st_mtime >= roads.st_mtime) &&
+            load_contraction_hierarchy(HIERARCHY_FILE, ch)) {
+            return 1;
+        }
+        if (!have_roads) {
+            return 0;
+        }
 
-    for (int i = 0; i < graph->num_vertices; i++) {
-        if (strcmp(graph->locations[i].name, hospital_name) == 0) {
-            // Check if the specialization is valid
-            const char* specialization = graph->locations[i].specialization;
-            int is_valid_specialization = 0;
+        printf("Preprocessing road network...\n");
+        long long start = now_us();
+        if (!build_contraction_hierarchy(ROADS_FILE, ch)) {
+            return 0;
+        }
+        // Timings go to stderr so replayed sessions compare equal
+        fprintf(stderr, "Contracted %d road nodes in %.1f s\n", ch->num_nodes, (now_us() - start) / 1e6);
+        save_contraction_hierarchy(ch, HIERARCHY_FILE);
+        return 1;
+    }
 
-            for (int j = 0; j < num_specializations; j++) {
-                if (strcmp(specialization, valid_specializations[j]) == 0) {
-                    is_valid_specialization = 1;
-                    break;
+    // Searches rings of grid cells outwards from the point's cell until no
+    // unvisited cell can hold a node closer than the best one found
+    int nearest_road_node(struct ContractionHierarchy* ch, double lat, double lon) {
+        int row = grid_coordinate(lat, ch->grid_lat, ch->grid_cell, ch->grid_rows);
+        int col = grid_coordinate(lon, ch->grid_lon, ch->grid_cell, ch->grid_cols);
+
+        // km per degree, taking the narrowest longitude degree on the grid and
+        // a little off both because haversine and degree distances differ slightly
+        double far_lat = fmax(fabs(ch->grid_lat), fabs(ch->grid_lat + ch->grid_rows * ch->grid_cell));
+        double lat_km = 0.99 * 111.195;
+        double lon_km = lat_km * cos(fmin(far_lat, 89.0) * M_PI / 180.0);
+
+        int best = 0;
+        double best_distance = DBL_MAX;
+        int max_ring = ch->grid_rows > ch->grid_cols ? ch->grid_rows : ch->grid_cols;
+        for (int ring = 0; ring <= max_ring; ring++) {
+            for (int r = row - ring; r <= row + ring; r++) {
+                if (r < 0 || r >= ch->grid_rows) {
+                    continue;
+                }
+                // Only the border of the ring: every column on its top and
+                // bottom rows, the two end columns elsewhere
+                int step = (r == row - ring || r == row + ring) ? 1 : 2 * ring;
+                for (int c = col - ring; c <= col + ring; c += step > 0 ? step : 1) {
+                    if (c < 0 || c >= ch->grid_cols) {
+                        continue;
+                    }
+                    int cell = grid_cell_index(ch, r, c);
+                    for (int i = ch->cell_start[cell]; i < ch->cell_start[cell + 1]; i++) {
+                        int v = ch->cell_nodes[i];
+                        double distance = haversine_distance(lat, lon, ch->latitude[v], ch->longitude[v]);
+                        if (distance < best_distance) {
+                            best_distance = distance;
+                            best = v;
+                        }
+                    }
                 }
             }
+            // Unvisited cells lie beyond a side of the searched block that is
+            // not the edge of the grid; stop once they are all too far away
+            double bound = DBL_MAX;
+            if (row - ring > 0) {
+                bound = fmin(bound, (lat - (ch->grid_lat + (row - ring) * ch->grid_cell)) * lat_km);
+            }
+            if (row + ring < ch->grid_rows - 1) {
+                bound = fmin(bound, (ch->grid_lat + (row + ring + 1) * ch->grid_cell - lat) * lat_km);
+            }
+            if (col - ring > 0) {
+                bound = fmin(bound, (lon - (ch->grid_lon + (col - ring) * ch->grid_cell)) * lon_km);
+            }
+            if (col + ring < ch->grid_cols - 1) {
+                bound = fmin(bound, (ch->grid_lon + (col + ring + 1) * ch->grid_cell - lon) * lon_km);
+            }
+            if (best_distance <= bound) {
+                break; // DBL_MAX when every cell has been searched
+            }
+        }
+        return best;
+    }
 
-            if (!is_valid_specialization) {
-                // printf("Invalid Specialization for the Hospital: %s\n", hospital_name);
-                // return -2;
-                // printf("Invalid Hospital");
-                break;
+    void append_route_node(struct Route* route, int node) {
+        if (route->count == route->capacity) {
+            route->capacity = route->capacity == 0 ? 64 : route->capacity * 2;
+            route->nodes = realloc(route->nodes, route->capacity * sizeof(int));
+        }
+        route->nodes[route->count++] = node;
+    }
+
+    // The upward edge between a lower ranked node and one of its neighbours
+    struct RoadEdge* find_upward_edge(struct ContractionHierarchy* ch, int lower, int higher) {
+        for (int e = ch->first_edge[lower]; e < ch->first_edge[lower + 1]; e++) {
+            if (ch->edges[e].to == higher) {
+                return &ch->edges[e];
             }
+        }
+        return NULL;
+    }
 
-            return i;
+    // Appends the road nodes after `from` up to and including `to`, expanding shortcuts.
+    // A shortcut's middle node is ranked below both ends, so both halves are
+    // stored among the middle node's upward edges.
+    void unpack_route(struct ContractionHierarchy* ch, int from, int to, int middle, struct Route* route) {
+        if (middle == -1) {
+            append_route_node(route, to);
+            return;
         }
+        unpack_route(ch, from, middle, find_upward_edge(ch, middle, from)->middle, route);
+        unpack_route(ch, middle, to, find_upward_edge(ch, middle, to)->middle, route);
     }
-    return -1;
-}
 
+    // Bidirectional upward search; returns the travel time in minutes, or
+    // INFINITY when the nodes are not connected, and fills route if non-NULL
+    double road_route(struct ContractionHierarchy* ch, int source, int target, struct Route* route) {
+        int ends[2] = {source, target};
+        for (int dir = 0; dir < 2; dir++) {
+            ch->heap[dir].size = 0;
+            if (ch->dist[dir][ends[dir]] == INFINITY && ch->dist[1 - dir][ends[dir]] == INFINITY) {
+                ch->touched[ch->num_touched++] = ends[dir];
+            }
+            ch->dist[dir][ends[dir]] = 0;
+            ch->parent[dir][ends[dir]] = -1;
+            heap_push(&ch->heap[dir], 0, ends[dir]);
+        }
+
+        double best = INFINITY;
+        int meet = -1;
+        while (1) {
+            int progressed = 0;
+            for (int dir = 0; dir < 2; dir++) {
+                struct MinHeap* heap = &ch->heap[dir];
+                if (heap->size == 0 || heap->keys[0] >= best) {
+                    continue;
+                }
+                progressed = 1;
+
+                double d;
+                int u = heap_pop(heap, &d);
+                if (d > ch->dist[dir][u]) {
+                    continue;
+                }
+                if (d + ch->dist[1 - dir][u] < best) {
+                    best = d + ch->dist[1 - dir][u];
+                    meet = u;
+                }
+                for (int e = ch->first_edge[u]; e < ch->first_edge[u + 1]; e++) {
+                    int v = ch->edges[e].to;
+                    double nd = d + ch->edges[e].minutes;
+                    if (nd < ch->dist[dir][v]) {
+                        if (ch->dist[0][v] == INFINITY && ch->dist[1][v] == INFINITY) {
+                            ch->touched[ch->num_touched++] = v;
+                        }
+                        ch->dist[dir][v] = nd;
+                        ch->parent[dir][v] = u;
+                        ch->parent_edge[dir][v] = e;
+                        heap_push(heap, nd, v);
+                    }
+                }
+            }
+            if (!progressed) {
+                break;
+            }
+        }
+
+        if (route != NULL && meet != -1) {
+            // Walk back from the meeting node to the source, then unpack forwards
+            struct Route upward = {NULL, 0, 0};
+            for (int v = meet; v != source; v = ch->parent[0][v]) {
+                append_route_node(&upward, v);
+            }
+            append_route_node(route, source);
+            for (int i = upward.count - 1; i >= 0; i--) {
+                int v = upward.nodes[i];
+                unpack_route(ch, ch->parent[0][v], v, ch->edges[ch->parent_edge[0][v]].middle, route);
+            }
+            free(upward.nodes);
+
+            // The backward search tree leads from the meeting node down to the target
+            for (int v = meet; v != target; v = ch->parent[1][v]) {
+                unpack_route(ch, v, ch->parent[1][v], ch->edges[ch->parent_edge[1][v]].middle, route);
+            }
+        }
+
+        for (int i = 0; i < ch->num_touched; i++) {
+            ch->dist[0][ch->touched[i]] = INFINITY;
+            ch->dist[1][ch->touched[i]] = INFINITY;
+        }
+        ch->num_touched = 0;
+        return best;
+    }
 
+    int main(int argc, char* argv[]) {
+        if (argc == 4 && strcmp(argv[1], "--shard-worker") == 0) {
+            return run_shard_worker(atoi(argv[2]), atoi(argv[3]));
+        }
+        if ((argc == 6 || argc == 7) && strcmp(argv[1], "--shard-query") == 0) {
+            int open_hour = -1;
+            int hour = argc == 7 ? atoi(argv[6]) : -1;
+            if (hour >= 0 && hour < 24) {
+                time_t now = time(NULL);
+                open_hour = localtime(&now)->tm_wday * 24 + hour;
+            }
+            return sharded_radius_query(atoi(argv[2]), argv[3], atof(argv[4]), argv[5], open_hour);
+        }
+        if (argc >= 5 && strcmp(argv[1], "--replay") == 0) {
+            return replay_sessions(atoi(argv[2]), atof(argv[3]), argc - 4, argv + 4);
+        }
+        if (argc == 3 && strcmp(argv[1], "--record") == 0) {
+            // Record this run, then carry on as a normal interactive session
+            if (!start_session_recording(argv[2])) {
+                return 1;
+            }
+        }
 
-    int main() {
         FILE* file = fopen("colleges.txt", "r");
         FILE* file1 = fopen("hospitals.txt", "r");
         FILE* file2 = fopen("info.txt", "r");
@@ -600,6 +3072,9 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
             strcpy(location.name, name);
             location.latitude = lat;
             location.longitude = lon;
+            location.specialization[0] = '\0';
+            location.specialization_id = -1;
+            memset(location.open_hours, 0xff, sizeof(location.open_hours));
 
             graph.locations[graph.num_vertices] = location;
 
@@ -617,6 +3092,7 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
         }
 
         fclose(file);
+        graph.num_colleges = graph.num_vertices;
 
         while (fgets(line, sizeof(line), file1)) {
             char name[MAX_NAME_LENGTH];
@@ -629,6 +3105,8 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
             location.latitude = lat;
             location.longitude = lon;
             strcpy(location.specialization, specialization);
+            location.specialization_id = get_specialization_id(specialization);
+            memset(location.open_hours, 0xff, sizeof(location.open_hours)); // until info.txt says otherwise
 
             graph.locations[graph.num_vertices] = location;
 
@@ -648,26 +3126,25 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
         fclose(file1);
 
         struct HashTable hash_table;
-        for (int i = 0; i < MAX_LOCATIONS; i++) {
-            hash_table.buckets[i] = NULL;
-        }
+        init_hash_table(&hash_table);
 
         while (fgets(line, sizeof(line), file2)) {
             char name[MAX_NAME_LENGTH];
-            float rating;
-            char timing[MAX_NAME_LENGTH];
-            char address[MAX_NAME_LENGTH * 2];
-            int fees;
-            sscanf(line, "%[^;];%f;%[^;];%d;%[^\n]", name, &rating, timing, &fees, address);
+            // Fields sscanf cannot read keep these "missing" values
+            float rating = NAN;
+            char timing[MAX_NAME_LENGTH] = "";
+            char address[MAX_NAME_LENGTH * 2] = "";
+            int fees = FEES_UNKNOWN;
+            if (sscanf(line, "%[^;];%f;%[^;];%d;%[^\n]", name, &rating, timing, &fees, address) < 1) {
+                continue; // Blank line
+            }
 
-            struct info hospital_info;
-            strcpy(hospital_info.name, name);
-            hospital_info.rating = rating;
-            strcpy(hospital_info.timing, timing);
-            hospital_info.fees = fees;
-            strcpy(hospital_info.address, address);
+            insert_hash_node(&hash_table, name, rating, timing, fees, address);
 
-            insert_hash_node(&hash_table, hospital_info);
+            int location_index = find_location_index(&graph, name);
+            if (location_index != -1) {
+                parse_working_hours(timing, graph.locations[location_index].open_hours);
+            }
         }
 
         fclose(file2);
@@ -691,7 +3168,10 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
         printf("1. Get List and information of Hospitals\n");
         printf("2. Give a Rating\n");
         printf("3. Add/Display Comment\n");
-        printf("\nEnter your choice (1 or 2 or 3): ");
+        printf("4. Export nearest hospitals for all colleges (CSV)\n");
+        printf("5. Search hospitals with filters\n");
+        printf("6. Road route from a college to a hospital\n");
+        printf("\nEnter your choice (1 to 6): ");
         scanf("%d", &user_choice);
 
         if (user_choice == 1) {
@@ -738,16 +3218,24 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
             fgets(specialization, sizeof(specialization), stdin);
             specialization[strcspn(specialization, "\n")] = '\0';
 
-            find_nearest_hospitals(&graph, source, max_distance, specialization, &hash_table);
+            int hour;
+            int open_hour = -1;
+            printf("\nShow only hospitals open at hour (0-23, -1 for any time): ");
+            if (scanf("%d", &hour) == 1 && hour >= 0 && hour < 24) {
+                time_t now = time(NULL);
+                open_hour = localtime(&now)->tm_wday * 24 + hour;
+            }
+
+            find_nearest_hospitals(&graph, source, max_distance, specialization, open_hour, &hash_table);
 
             printf("\n");
             printf("_____________________________________________________________________________________________________\n\n");
             printf("Do you want more details of the hospitals? (YES/NO): ");
-            char choice[3];
-            scanf("%s",choice);
+            char choice[4];
+            scanf("%3s",choice);
             printf("\n_____________________________________________________________________________________________________\n\n");
             if (strcmp(choice, "YES")==0){
-                details(&graph, source, max_distance, specialization, &hash_table);
+                details(&graph, source, max_distance, specialization, open_hour, &hash_table);
             }
 
             // Save reviews before exiting the program
@@ -756,19 +3244,106 @@ int get_hospital_index(struct Graph* graph, const char* hospital_name) {
         } else if (user_choice == 2) {
             // Give a review
             review_hospitals(&graph, &hash_table);
+        } else if (user_choice == 4) {
+            // Nearest hospitals of every specialization for every college
+            int k;
+            printf("\nEnter the number of nearest hospitals per specialization (1-%d): ", MAX_NEAREST);
+            scanf("%d", &k);
+
+            int hour;
+            int open_hour = -1;
+            printf("\nShow only hospitals open at hour (0-23, -1 for any time): ");
+            if (scanf("%d", &hour) == 1 && hour >= 0 && hour < 24) {
+                time_t now = time(NULL);
+                open_hour = localtime(&now)->tm_wday * 24 + hour;
+            }
+            export_nearest_hospitals(&graph, k, open_hour, "nearest_hospitals.csv");
+        } else if (user_choice == 5) {
+            // Compound filters over fees, rating, specialization, distance and open hours
+            static struct HospitalColumns columns;
+            build_hospital_columns(&graph, &hash_table, &columns);
+
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF);
+            printf("\nEnter the College Name: ");
+            fgets(location_name, sizeof(location_name), stdin);
+            location_name[strcspn(location_name, "\n")] = '\0';
+
+            int source = find_location_index(&graph, location_name);
+            if (source == -1 || source >= graph.num_colleges) {
+                printf("Invalid College Name.\n");
+                return 1;
+            }
+
+            char query[MAX_NAME_LENGTH];
+            printf("\nEnter filters (e.g. dist<=5 fees<500 rating>=4.0 spec=MULTISPECIALITY open=21 sort=-rating): ");
+            fgets(query, sizeof(query), stdin);
+            query[strcspn(query, "\n")] = '\0';
+
+            filter_hospitals(&graph, &columns, source, query);
+        } else if (user_choice == 6) {
+            // Travel time and route over the road network
+            static struct ContractionHierarchy ch;
+            if (!open_road_network(&ch)) {
+                printf("No road network available. Add %s to enable routing.\n", ROADS_FILE);
+                return 1;
+            }
+
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF);
+            printf("\nEnter the College Name: ");
+            fgets(location_name, sizeof(location_name), stdin);
+            location_name[strcspn(location_name, "\n")] = '\0';
+            int source = find_location_index(&graph, location_name);
+            if (source == -1 || source >= graph.num_colleges) {
+                printf("Invalid College Name.\n");
+                return 1;
+            }
+
+            char hospital_name[MAX_NAME_LENGTH];
+            printf("Enter the Hospital Name: ");
+            fgets(hospital_name, sizeof(hospital_name), stdin);
+            hospital_name[strcspn(hospital_name, "\n")] = '\0';
+            int destination = find_location_index(&graph, hospital_name);
+            if (destination < graph.num_colleges) {
+                printf("Invalid Hospital Name.\n");
+                return 1;
+            }
+
+            int from = nearest_road_node(&ch, graph.locations[source].latitude, graph.locations[source].longitude);
+            int to = nearest_road_node(&ch, graph.locations[destination].latitude, graph.locations[destination].longitude);
+
+            struct Route route = {NULL, 0, 0};
+            long long start = now_us();
+            double minutes = road_route(&ch, from, to, &route);
+            long long elapsed = now_us() - start;
+
+            if (minutes == INFINITY) {
+                printf("\nNo road route found from %s to %s.\n", location_name, hospital_name);
+            } else {
+                printf("\nTravel time from %s to %s: %.1f minutes\n", location_name, hospital_name, minutes);
+                fprintf(stderr, "Route query took %.3f ms\n", elapsed / 1000.0);
+                printf("Route through %d road points:\n", route.count);
+                for (int i = 0; i < route.count; i++) {
+                    printf("%d. (%.6lf, %.6lf)\n", i + 1, ch.latitude[route.nodes[i]], ch.longitude[route.nodes[i]]);
+                }
+            }
+            free(route.nodes);
         }else if (user_choice == 3) {
             // Add or display comment
             printf("1. Add Comment\n");
             printf("2. Display Comments\n");
-            printf("Enter your choice (1 or 2): ");
+            printf("3. Search Comments\n");
+            printf("Enter your choice (1, 2 or 3): ");
             int comment_choice;
             if (scanf("%d", &comment_choice) != 1) {
-                printf("Invalid input. Please enter 1 or 2.\n");
+                printf("Invalid input. Please enter 1, 2 or 3.\n");
                 while (getchar() != '\n');
                     // continue;
             }
             getchar(); // Consume the newline character
             load_comments_from_file(comments, &num_comments, "comments.txt");
+            open_comment_index(&comment_index, "comments.txt");
 if (comment_choice == 1) {
     // Add Comment
     char hospital_name[MAX_NAME_LENGTH];
@@ -815,6 +3390,14 @@ if (comment_choice == 1) {
         // Display comments if the hospital name is valid
         display_comments(comments, num_comments, hospital_name);
     }
+} else if (comment_choice == 3) {
+    // Search Comments
+    char query[MAX_NAME_LENGTH];
+    printf("Enter words to search for: ");
+    fgets(query, sizeof(query), stdin);
+    query[strcspn(query, "\n")] = '\0';
+
+    search_comments(&comment_index, "comments.txt", query);
 } else {
     printf("Invalid choice for comments.\n");
 }
@@ -823,9 +3406,10 @@ if (comment_choice == 1) {
 
 
 
-// Save reviews and comments before exiting the program
+// Save reviews and the comment index before exiting the program. Comments
+// themselves were already appended to comments.txt by add_comment().
 save_reviews_to_file(&hash_table, "reviews.txt");
-save_comments_to_file(comments, num_comments, "comments.txt");
+save_comment_index(&comment_index, COMMENT_INDEX_FILE);
 
 return 0;
 